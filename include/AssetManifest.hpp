@@ -0,0 +1,92 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ASSETMANIFEST_HPP
+#define ASSETMANIFEST_HPP
+
+#include <string>
+#include <vector>
+
+namespace TiltBall
+{
+    // the files the game loads, by Ogre resource group. generated at build
+    // time from a short list of root assets, following the references in
+    // CEGUI schemes, imagesets and fonts and in Ogre material and font
+    // scripts, so only what is actually used gets registered at startup
+    class AssetManifest
+    {
+    public:
+        struct Asset
+        {
+            std::string m_group;
+
+            // relative to the resource directory
+            std::string m_path;
+        };
+
+        AssetManifest();
+
+        AssetManifest(const AssetManifest& p_other) = delete;
+
+        AssetManifest& operator=(const AssetManifest& p_other) = delete;
+
+        // reads a manifest written by save()
+        void load(std::string p_fileName);
+
+        void save(std::string p_fileName) const;
+
+        // replaces the assets with the roots listed in p_rootsFileName and
+        // everything they reference. each line of the roots file is either
+        //     search <group> <directory>
+        // giving a directory (relative to p_resourceDirectory) the group's
+        // files are looked up in, or
+        //     root <group> <file name>
+        // naming a file the game loads directly
+        void generate(std::string p_rootsFileName, std::string p_resourceDirectory);
+
+        const std::vector<Asset>& getAssets() const;
+
+        // in the order they first appear
+        std::vector<std::string> getGroups() const;
+
+        // the directories holding the group's assets, each listed once
+        std::vector<std::string> getDirectories(std::string p_group) const;
+
+    private:
+        struct SearchDirectory
+        {
+            std::string m_group;
+            std::string m_directory;
+        };
+
+        // finds p_name in the group's search directories and adds it,
+        // unless it is already there. a name with a directory in it, or
+        // one found in more than one directory, is an error, since the
+        // game looks resources up by bare name
+        void addAsset(std::string p_group,
+                      std::string p_name,
+                      std::string p_referrer,
+                      const std::vector<SearchDirectory>& p_searchDirectories,
+                      std::string p_resourceDirectory);
+
+        std::vector<Asset> m_assets;
+    };
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ASSETPACK_HPP
+#define ASSETPACK_HPP
+
+#include "AssetManifest.hpp"
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TiltBall
+{
+    // all the assets of the manifest in one file (see write), memory
+    // mapped as a whole and handed out as views into the mapping, so
+    // starting the game takes a handful of reads instead of one per file.
+    // a pack mounted on the resource directory is where openFile() looks
+    // first, for the level loader and the audio; Ogre and CEGUI reach it
+    // through PackArchive
+    class AssetPack
+    {
+    public:
+        explicit AssetPack(std::string p_fileName);
+
+        AssetPack(const AssetPack& p_other) = delete;
+
+        AssetPack& operator=(const AssetPack& p_other) = delete;
+
+        // in the order they first appear
+        std::vector<std::string> getGroups() const;
+
+        // the paths of the group's files, relative to the resource
+        // directory
+        std::vector<std::string> getPaths(std::string p_group) const;
+
+        // p_path is relative to the resource directory; null when the
+        // pack does not have it
+        std::shared_ptr<MappedFile> open(std::string p_path) const;
+
+        bool contains(std::string p_path) const;
+
+        // packs the assets in p_resourceDirectory, each file stored once
+        // even when it is in several groups
+        static void write(const std::vector<AssetManifest::Asset>& p_assets,
+                          std::string p_resourceDirectory,
+                          std::string p_fileName);
+
+        // files under p_directory are looked up in p_pack from now on;
+        // meant to happen once at startup, before any thread loads files
+        static void mount(std::string p_directory, std::shared_ptr<AssetPack> p_pack);
+
+        // null if nothing is mounted on p_directory
+        static std::shared_ptr<AssetPack> getMounted(std::string p_directory);
+
+        // the file from a mounted pack if there is one holding it, the
+        // loose file otherwise
+        static std::shared_ptr<MappedFile> openFile(std::string p_fileName);
+
+        static bool exists(std::string p_fileName);
+
+        static constexpr unsigned int VERSION = 1;
+
+        // every file starts at a multiple of this, so binary levels can be
+        // used in place like a mapping of their own
+        static constexpr std::size_t DATA_ALIGNMENT = 16;
+
+    private:
+        struct Entry
+        {
+            std::string m_group;
+            std::size_t m_offset;
+            std::size_t m_size;
+        };
+
+        // finds the pack mounted on a directory p_fileName is in, and the
+        // path of the file relative to it
+        static std::shared_ptr<AssetPack> findMount(std::string p_fileName, std::string& p_path);
+
+        std::shared_ptr<MappedFile> m_file;
+
+        // by path; a file in several groups has an entry for each
+        std::multimap<std::string, Entry> m_entries;
+    };
+}
+
+#endif
@@ -22,10 +22,18 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 #define	AUDIOSYSTEM_HPP
 
 #include <AL/al.h>
-#include <vector>
+#include <atomic>
+#include <chrono>
+#include <future>
 
 namespace TiltBall
 {
+    class MusicStream;
+    class VoicePool;
+
+    // opens the audio device and loads the sounds in the background, the
+    // game does not wait for it; until it is done playing a sound does
+    // nothing
     class AudioSystem
     {
     public:
@@ -37,15 +45,45 @@ namespace TiltBall
 
         ~AudioSystem();
 
+        bool isReady() const;
+
         void playClickSound();
 
+        // the ball hitting a wall with the given impulse; soft and too
+        // frequent impacts are left out so a ball rattling along a
+        // corridor can't take over every voice
+        void playImpactSound(float p_impulse);
+
+        enum Priority
+        {
+            PRIORITY_IMPACT,
+            PRIORITY_INTERFACE
+        };
+
+        static constexpr int VOICE_COUNT = 16;
+        static constexpr int MAX_IMPACT_VOICES = 4;
+        static constexpr float MIN_IMPACT_IMPULSE = 150;
+        // impulse of an impact at full volume
+        static constexpr float LOUDEST_IMPACT_IMPULSE = 2000;
+        static constexpr int MIN_IMPACT_INTERVAL_MILLISECONDS = 60;
+
     private:
-        std::vector<char> m_vorbisBuffer;
+        // runs in the background, leaves audio off if loading fails
+        void initialize();
+
+        // throws if there is no audio to be had
+        void load();
+
+        std::future<void> m_initialization;
+        std::atomic<bool> m_ready;
+        bool m_alutInitialized;
+
+        MusicStream* m_music;
+        VoicePool* m_voices;
 
-        ALuint m_musicBuffer;
-        ALuint m_musicSource;
         ALuint m_clickSoundBuffer;
-        ALuint m_clickSoundSource;
+
+        std::chrono::steady_clock::time_point m_lastImpact;
     };
 }
 
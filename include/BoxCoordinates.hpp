@@ -18,31 +18,42 @@ You should have received a copy of the GNU General Public License
 along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#ifndef WORLDOBJECT_HPP
-#define	WORLDOBJECT_HPP
-
-#include <btBulletDynamicsCommon.h>
-#include <OGRE/Ogre.h>
+#ifndef BOXCOORDINATES_HPP
+#define BOXCOORDINATES_HPP
 
 namespace TiltBall
 {
-    class WorldObject
+    // axis aligned box given by two opposite corners, used to describe
+    // level geometry independently of its graphics and physics representations
+    class BoxCoordinates
     {
     public:
-        WorldObject(Ogre::MovableObject* p_movableObject,
-                    btCollisionShape* p_collisionShape,
-                    btTransform p_transform);
+        BoxCoordinates(float p_x1,
+                       float p_y1,
+                       float p_z1,
+                       float p_x2,
+                       float p_y2,
+                       float p_z2);
+
+        float getX1() const;
+
+        float getY1() const;
+
+        float getZ1() const;
 
-        Ogre::MovableObject* getMovableObject();
+        float getX2() const;
 
-        btCollisionShape* getCollisionShape();
+        float getY2() const;
 
-        btTransform getTransform();
+        float getZ2() const;
 
     private:
-        Ogre::MovableObject* m_movableObject;
-        btCollisionShape* m_collisionShape;
-        btTransform m_transform;
+        float m_x1;
+        float m_y1;
+        float m_z1;
+        float m_x2;
+        float m_y2;
+        float m_z2;
     };
 }
 
@@ -29,11 +29,19 @@ namespace TiltBall
 {
     class Engine;
 
+    // collects the lines bullet draws and hands them to Ogre as a single
+    // dynamic ManualObject, rewritten in place whenever the lines change
     class BulletDebugDrawer : public btIDebugDraw
     {
     public:
         explicit BulletDebugDrawer(Engine* p_engine);
 
+        BulletDebugDrawer(const BulletDebugDrawer& p_other) = delete;
+
+        BulletDebugDrawer& operator=(const BulletDebugDrawer& p_other) = delete;
+
+        ~BulletDebugDrawer();
+
         void drawLine(const btVector3& p_from,
                       const btVector3& p_to,
                       const btVector3& p_color);
@@ -53,12 +61,38 @@ namespace TiltBall
 
         int getDebugMode() const;
 
+        // forgets the lines drawn so far
         void clear();
 
+        // shows the lines drawn since the last clear()
+        void update();
+
+        // destroys the line object and its node; call before the scene
+        // is cleared, they are created again once there is something to
+        // draw
+        void resetScene();
+
     private:
+        struct LineVertex
+        {
+            float m_position[3];
+            float m_colour[3];
+        };
+
+        void addVertex(const btVector3& p_position, const btVector3& p_colour);
+
+        void createSceneObjects();
+
         Engine* m_engine;
         Ogre::Material* m_material;
-        std::vector<Ogre::SceneNode*> m_lines;
+        // null until something is drawn, and again after resetScene()
+        Ogre::SceneNode* m_node;
+        Ogre::ManualObject* m_lineObject;
+
+        // kept between frames so drawing allocates nothing once it has
+        // grown big enough
+        std::vector<LineVertex> m_vertices;
+        std::size_t m_shownVertexCount;
     };
 }
 #endif
@@ -0,0 +1,72 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLIDERCACHE_HPP
+#define COLLIDERCACHE_HPP
+
+#include "LevelCollider.hpp"
+#include "LevelDescription.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <utility>
+
+namespace TiltBall
+{
+    // keeps level colliders around between loads of a level, so reloading
+    // one reuses its collision shapes instead of building them again. the
+    // BVHs of triangle mesh colliders are also kept in files, keyed by the
+    // hash of the level file, so they survive restarts. safe to use from
+    // several threads, so levels can be prepared in the background
+    class ColliderCache
+    {
+    public:
+        // p_directory is created if it does not exist
+        explicit ColliderCache(std::string p_directory);
+
+        ColliderCache(const ColliderCache& p_other) = delete;
+
+        ColliderCache& operator=(const ColliderCache& p_other) = delete;
+
+        std::shared_ptr<LevelCollider> getCollider(const LevelDescription& p_description,
+                                                   LevelCollider::ColliderType p_colliderType);
+
+        // forgets the colliders held in memory; the files stay
+        void clear();
+
+    private:
+        std::string buildBvhFileName(uint64_t p_fileHash) const;
+
+        std::string m_directory;
+
+        // only guards the map; colliders are built without holding it, so
+        // two threads may occasionally build the same one
+        std::mutex m_mutex;
+
+        // levels are small and there are few of them, so colliders are
+        // kept for every level seen until cleared
+        std::map<std::pair<uint64_t, int>, std::shared_ptr<LevelCollider>> m_colliders;
+    };
+}
+
+#endif
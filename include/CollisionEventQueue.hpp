@@ -0,0 +1,73 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COLLISIONEVENTQUEUE_HPP
+#define COLLISIONEVENTQUEUE_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace TiltBall
+{
+    // something that happened to the ball during a physics step
+    struct CollisionEvent
+    {
+        enum Type
+        {
+            EVENT_TARGET_REACHED,
+            EVENT_WALL_IMPACT,
+            EVENT_HAZARD_HIT
+        };
+
+        Type m_type;
+
+        // the largest impulse bullet applied at the contact, zero for
+        // anything but walls
+        float m_impulse;
+    };
+
+    // collision events recorded from inside the physics tick and handled once
+    // the step is over, when it is safe to change the world; keeps its
+    // storage, so recording allocates nothing once it has grown big enough
+    class CollisionEventQueue
+    {
+    public:
+        CollisionEventQueue();
+
+        CollisionEventQueue(const CollisionEventQueue& p_other) = delete;
+
+        CollisionEventQueue& operator=(const CollisionEventQueue& p_other) = delete;
+
+        void push(CollisionEvent::Type p_type, float p_impulse);
+
+        // hands out the events oldest first, false once there are no more
+        bool pop(CollisionEvent& p_event);
+
+        void clear();
+
+        static constexpr std::size_t INITIAL_CAPACITY = 64;
+
+    private:
+        std::vector<CollisionEvent> m_events;
+        std::size_t m_next;
+    };
+}
+
+#endif
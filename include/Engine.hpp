@@ -22,14 +22,23 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 #define ENGINE_HPP
 
 #include "BulletDebugDrawer.hpp"
+#include "ColliderCache.hpp"
+#include "FrameProfiler.hpp"
+#include "FrozenFrame.hpp"
 #include "GameState.hpp"
+#include "GuiRenderQueueListener.hpp"
 #include "InputSystem.hpp"
+#include "PackArchive.hpp"
+#include "PhysicsWorld.hpp"
+#include "ProfilerOverlay.hpp"
 
 #include <btBulletDynamicsCommon.h>
 #include <CEGUI/CEGUI.h>
 #include <OGRE/Ogre.h>
 #include <CEGUI/RendererModules/Ogre/Renderer.h>
 #include <OIS/OIS.h>
+#include <chrono>
+#include <string>
 #include <vector>
 
 namespace TiltBall
@@ -37,8 +46,9 @@ namespace TiltBall
     class AudioSystem;
     class BulletDebugDrawer;
     class GameState;
+    class MenuState;
 
-    class Engine: public Ogre::FrameListener
+    class Engine
     {
     public:
         Engine();
@@ -49,11 +59,30 @@ namespace TiltBall
 
         ~Engine();
 
+        // pauses the current state, see GameState::pause()
         void pushState(GameState* p_state);
 
+        // built on first use and kept, popping it does not delete it
+        MenuState* getMenuState();
+
+        // runs input updates, simulation and rendering each at their own
+        // rate, sleeping whenever none of them is due
         void mainLoop();
 
-        bool frameStarted(const Ogre::FrameEvent& p_event);
+        // a rate of 0 means on every pass through the main loop
+        void setInputRate(float p_updatesPerSecond);
+
+        void setSimulationRate(float p_updatesPerSecond);
+
+        // a rate of 0 means as fast as the render window allows
+        void setRenderRate(float p_framesPerSecond);
+
+        // the window is created with vsync on
+        void setVSyncEnabled(bool p_enabled);
+
+        // parses the group's scripts (materials, overlays, fonts) unless
+        // that already happened; call before using anything from it
+        void loadResourceGroup(std::string p_group);
 
         Ogre::Root* getOgreRoot();
 
@@ -61,33 +90,70 @@ namespace TiltBall
 
         AudioSystem* getAudioSystem();
 
+        PhysicsWorld* getPhysicsWorld();
+
         btDiscreteDynamicsWorld* getDynamicsWorld();
 
+        ColliderCache* getColliderCache();
+
         BulletDebugDrawer* getDebugDrawer();
 
+        FrameProfiler* getProfiler();
+
+        // created on first use
+        ProfilerOverlay* getProfilerOverlay();
+
+        // for states that do not need continuous rendering: draw another
+        // frame once the next one is due
+        void requestRedraw();
+
         void requestPop();
 
         void requestQuit();
 
-        float getTimeSinceLastFrame();
-
         GameState* getCurrentState();
 
     private:
+        // resumes the state below, see GameState::resume()
         void popState();
 
-        static constexpr float INPUT_UPDATE_INTERVAL = 0.02;
+        // applies the state's PausedRendering while it is paused
+        void pauseState(GameState* p_state);
+
+        void resumeState(GameState* p_state);
+
+        // null before a level has set up the viewport
+        Ogre::Viewport* getMainViewport();
+
+        // adds the groups of the mounted asset pack, or without one the
+        // directories listed in the asset manifest
+        void registerResources();
+
+        static float rateToInterval(float p_rate);
+
+        static double scheduleNext(double p_due, double p_interval, double p_now);
+
+        static constexpr float DEFAULT_INPUT_RATE = 100;
+        // the physics world already steps at its own fixed rate and
+        // interpolates in between, so simulating on every pass (right
+        // before each input update and frame) only keeps the interpolated
+        // positions fresh; a fixed rate here would make them lag the frames
+        static constexpr float DEFAULT_SIMULATION_RATE = 0;
+        // safety net for when vsync is off or ignored by the driver
+        static constexpr float DEFAULT_RENDER_RATE = 250;
+        static constexpr bool DEFAULT_VSYNC = true;
+
+        // start of the engine's construction, for the startup times in the
+        // log; first so it is initialized before anything else
+        std::chrono::steady_clock::time_point m_startTime;
 
         // heap object because we have to allocate it within a method
         // and return it from the method
         Ogre::Root* m_ogreRoot;
         Ogre::Root* initOgreRoot();
 
-        btDefaultCollisionConfiguration* m_collisionConfiguration;
-        btCollisionDispatcher* m_dispatcher;
-        btBroadphaseInterface* m_broadphase;
-        btConstraintSolver* m_solver;
-        btDiscreteDynamicsWorld* m_dynamicsWorld;
+        PhysicsWorld* m_physicsWorld;
+        ColliderCache* m_colliderCache;
         BulletDebugDrawer* m_debugDrawer;
 
         InputSystem* m_inputSystem;
@@ -95,14 +161,37 @@ namespace TiltBall
 
         CEGUI::OgreRenderer* m_ceguiRenderer;
 
-        float m_timeSinceLastFrame;
+        FrameProfiler* m_profiler;
+        ProfilerOverlay* m_profilerOverlay;
+        FrozenFrame* m_frozenFrame;
+
+        // null unless the resources come from the asset pack
+        PackArchiveFactory* m_packArchiveFactory;
+        GuiRenderQueueListener* m_guiRenderQueueListener;
+
+        // in seconds, 0 meaning every pass through the main loop
+        float m_inputInterval;
+        float m_simulationInterval;
+        float m_renderInterval;
+
         std::vector<GameState*> m_states;
 
+        MenuState* m_menuState;
+
+        // room for every state at once, so pushing one never allocates
+        static constexpr int STATE_CAPACITY = 8;
+
+        bool m_requestRedraw;
         bool m_requestPop;
         bool m_requestQuit;
-    };
 
-    void bulletTickCallback(btDynamicsWorld* p_world, btScalar p_timeStep);
+        bool m_firstFrameRendered;
+
+        // the visibility mask of the main viewport while a paused state
+        // shows nothing of its scene
+        Ogre::uint32 m_hiddenVisibilityMask;
+        bool m_sceneHidden;
+    };
 }
 
 #endif
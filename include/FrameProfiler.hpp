@@ -0,0 +1,150 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FRAMEPROFILER_HPP
+#define FRAMEPROFILER_HPP
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+namespace TiltBall
+{
+    // adds up how long each part of a frame takes and keeps the last few
+    // hundred frames around for percentiles and dumps; knows nothing about
+    // Ogre, so the physics can be timed headless too. sections are
+    // exclusive: time spent in a section begun inside another one (the GUI
+    // inside rendering) counts for the inner section only, so the sections
+    // of a frame add up to no more than the whole frame.
+    //
+    // a frame ends with each one rendered, and everything timed since the
+    // last one is put down for it. input is captured at its own rate, so
+    // not every frame has an input capture (or a physics step) before it;
+    // a section only has a sample in the frames it ran in, and its
+    // percentiles are taken over those frames alone
+    class FrameProfiler
+    {
+    public:
+        enum Section
+        {
+            SECTION_INPUT,
+            SECTION_PHYSICS_STEP,
+            SECTION_MOTION_STATES,
+            SECTION_DEBUG_DRAW,
+            SECTION_GUI,
+            SECTION_RENDER,
+            SECTION_FRAME,
+            SECTION_COUNT
+        };
+
+        struct Percentiles
+        {
+            // in milliseconds
+            double m_p50;
+            double m_p95;
+            double m_p99;
+        };
+
+        // times a section from construction to destruction; a null
+        // profiler times nothing
+        class Scope
+        {
+        public:
+            Scope(FrameProfiler* p_profiler, Section p_section);
+
+            Scope(const Scope& p_other) = delete;
+
+            Scope& operator=(const Scope& p_other) = delete;
+
+            ~Scope();
+
+        private:
+            FrameProfiler* m_profiler;
+            Section m_section;
+        };
+
+        FrameProfiler();
+
+        FrameProfiler(const FrameProfiler& p_other) = delete;
+
+        FrameProfiler& operator=(const FrameProfiler& p_other) = delete;
+
+        // sections may begin and end several times a frame, the times add
+        // up; nested sections have to end before the one around them
+        void begin(Section p_section);
+
+        void end(Section p_section);
+
+        // closes the current frame, timing the whole frame as well
+        void endFrame();
+
+        // over the frames kept that p_section ran in, zero if there are
+        // none
+        Percentiles getPercentiles(Section p_section);
+
+        int getFrameCount() const;
+
+        // how many of the frames kept p_section ran in
+        int getSampleCount(Section p_section) const;
+
+        static const char* getSectionName(Section p_section);
+
+        // one row per frame kept, oldest first, in milliseconds; sections
+        // that did not run in a frame are left empty
+        void writeCsv(std::ostream& p_stream) const;
+
+        // the frames kept plus the percentiles and sample count of each
+        // section; sections that did not run in a frame are null
+        void writeJson(std::ostream& p_stream);
+
+        static constexpr int HISTORY_FRAMES = 600;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        // milliseconds of p_section in the p_frame-th oldest frame kept
+        float getFrameTime(int p_frame, Section p_section) const;
+
+        bool hasSample(int p_frame, Section p_section) const;
+
+        int getHistoryRow(int p_frame) const;
+
+        Clock::time_point m_sectionStarted[SECTION_COUNT];
+        double m_currentFrame[SECTION_COUNT];
+        bool m_currentSampled[SECTION_COUNT];
+
+        // the sections begun and not yet ended, innermost last
+        Section m_openSections[SECTION_COUNT];
+        int m_openCount;
+        Clock::time_point m_frameStarted;
+
+        // HISTORY_FRAMES rows of SECTION_COUNT times, used as a ring, and
+        // whether each section ran in the frame
+        std::vector<float> m_history;
+        std::vector<unsigned char> m_sampled;
+        int m_nextFrame;
+        int m_frameCount;
+
+        // reused for sorting, so percentiles allocate nothing
+        std::vector<float> m_sorted;
+    };
+}
+
+#endif
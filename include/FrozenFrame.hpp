@@ -0,0 +1,67 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef FROZENFRAME_HPP
+#define FROZENFRAME_HPP
+
+#include <OGRE/Ogre.h>
+
+namespace TiltBall
+{
+    // stands in for the scene of a paused state: the scene is drawn once
+    // into a texture, which a full screen overlay then shows while the
+    // viewport itself draws no scene at all
+    class FrozenFrame
+    {
+    public:
+        FrozenFrame();
+
+        FrozenFrame(const FrozenFrame& p_other) = delete;
+
+        FrozenFrame& operator=(const FrozenFrame& p_other) = delete;
+
+        // draws the viewport's scene into the texture and shows that in
+        // its place
+        void capture(Ogre::Viewport* p_viewport);
+
+        // the viewport draws its scene again
+        void release();
+
+        bool isCaptured() const;
+
+    private:
+        // the material and overlay are made the first time a frame is
+        // captured and kept for the next time; Ogre cleans them up when it
+        // shuts down
+        void create();
+
+        // replaces the texture with one of the given size, for the first
+        // capture and whenever the viewport has changed size since
+        void createTexture(int p_width, int p_height);
+
+        Ogre::TexturePtr m_texture;
+        Ogre::TextureUnitState* m_textureUnit;
+        Ogre::Overlay* m_overlay;
+
+        Ogre::Viewport* m_viewport;
+        Ogre::uint32 m_visibilityMask;
+    };
+}
+
+#endif
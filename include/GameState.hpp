@@ -33,16 +33,45 @@ namespace TiltBall
         public OIS::KeyListener
     {
     public:
+        // how a state is drawn while another one is on top of it
+        enum PausedRendering
+        {
+            // its scene keeps being drawn every frame
+            PAUSED_RENDER_LIVE,
+
+            // its scene is drawn once when it is paused, and that frame is
+            // shown from then on
+            PAUSED_RENDER_FROZEN,
+
+            // nothing of its scene is drawn
+            PAUSED_RENDER_NONE
+        };
+
         explicit GameState(Engine* p_engine);
 
         virtual ~GameState() = 0;
 
+        // called by the engine when another state is pushed on top of this
+        // one, and when that one is popped again
         virtual void pause() = 0;
 
         virtual void resume() = 0;
 
+        // PAUSED_RENDER_LIVE unless overridden
+        virtual PausedRendering getPausedRendering() const;
+
+        // true unless overridden. a state that only changes what it shows
+        // in response to input returns false and calls
+        // Engine::requestRedraw() when it does, and the engine then draws
+        // (and wakes up for) nothing else
+        virtual bool needsContinuousRendering() const;
+
         virtual bool update(const Ogre::FrameEvent& p_event) = 0;
 
+        // called every frame with the real time since the previous frame,
+        // unlike update() which runs at the input update rate
+        virtual void simulate(float p_elapsed) = 0;
+
     protected:
         Engine* m_engine;
     };
@@ -0,0 +1,50 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GUIRENDERQUEUELISTENER_HPP
+#define GUIRENDERQUEUELISTENER_HPP
+
+#include "FrameProfiler.hpp"
+
+#include <OGRE/Ogre.h>
+
+namespace TiltBall
+{
+    // draws CEGUI at the end of the overlay queue instead of letting the
+    // CEGUI renderer do it on its own, so the GUI can be timed by itself
+    class GuiRenderQueueListener : public Ogre::RenderQueueListener
+    {
+    public:
+        explicit GuiRenderQueueListener(FrameProfiler* p_profiler);
+
+        GuiRenderQueueListener(const GuiRenderQueueListener& p_other) = delete;
+
+        GuiRenderQueueListener& operator=(const GuiRenderQueueListener& p_other) = delete;
+
+        void renderQueueEnded(Ogre::uint8 p_queueGroupId,
+                              const Ogre::String& p_invocation,
+                              bool& p_repeatThisInvocation);
+
+    private:
+        FrameProfiler* m_profiler;
+    };
+}
+
+#endif
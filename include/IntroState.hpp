@@ -39,6 +39,8 @@ namespace TiltBall
 
         bool update(const Ogre::FrameEvent& p_event);
 
+        void simulate(float p_elapsed);
+
         bool mouseMoved(const OIS::MouseEvent& evt);
 
         bool mousePressed(const OIS::MouseEvent& evt,
@@ -21,8 +21,10 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef LEVEL_HPP
 #define LEVEL_HPP
 
-#include "WallCoordinates.hpp"
-#include "WorldObject.hpp"
+#include "BoxCoordinates.hpp"
+#include "LevelGeometry.hpp"
+#include "LevelPhysics.hpp"
+#include "PreparedLevel.hpp"
 
 #include <btBulletDynamicsCommon.h>
 #include <OGRE/Ogre.h>
@@ -34,7 +36,8 @@ namespace TiltBall
     class Level
     {
     public:
-        Level(Engine* p_engine, std::string p_fileName);
+        // registers a prepared level with Ogre and the dynamics world
+        Level(Engine* p_engine, std::shared_ptr<PreparedLevel> p_preparedLevel);
 
         Level(const Level& p_other) = delete;
 
@@ -42,12 +45,16 @@ namespace TiltBall
 
         ~Level();
 
+        // puts the ball back at the start and the level back flat, keeping
+        // everything else as it is
+        void reset();
+
+        LevelPhysics* getPhysics();
+
         btRigidBody* getLevelBody();
 
         btRigidBody* getBallBody();
 
-        btRigidBody* getTargetBody();
-
         Ogre::SceneNode* getLevelNode();
 
         Ogre::SceneNode* getBallNode();
@@ -56,36 +63,36 @@ namespace TiltBall
 
         std::string getFileName();
 
-        std::string getNextLevelFileName();
+        std::shared_ptr<PreparedLevel> getPreparedLevel();
 
-    private:
-        Ogre::SceneNode* initSceneNode(Engine* p_engine,
-                                       std::string p_nodeName);
+        std::string getNextLevelFileName();
 
-        void load(std::string p_levelFileName);
+        // the instanced walls follow the level node in their shader, this
+        // passes its current transform on; does nothing for walls that are
+        // plain geometry
+        void updateWalls();
 
-        WorldObject buildBox(std::string p_name,
-                             std::string p_material,
-                             float p_x1,
-                             float p_y1,
-                             float p_z1,
-                             float p_x2,
-                             float p_y2,
-                             float p_z2);
+        // whether the render system and the wall material allow drawing
+        // the walls with hardware instancing
+        static bool supportsInstancedWalls(Engine* p_engine);
 
-        btRigidBody* attachBodyToPhysicsWorld(Ogre::SceneNode* p_sceneNode,
-                                              btCollisionShape* p_collisionShape,
-                                              float p_mass,
-                                              float p_originX,
-                                              float p_originY,
-                                              float p_originZ);
+        static constexpr int WALL_INSTANCES_PER_BATCH = 1024;
 
-        std::vector<WorldObject> buildBottomSurface(std::string p_bottomMaterial);
+    private:
+        Ogre::SceneNode* initSceneNode(Engine* p_engine,
+                                       std::string p_nodeName);
 
-        std::vector<WorldObject> buildWalls(std::string p_material);
+        // adds the geometry to the manual object as one section, which
+        // Ogre draws with a single call
+        void addSection(Ogre::ManualObject* p_manual,
+                        std::string p_material,
+                        const LevelGeometry& p_geometry);
 
         void buildLevel();
 
+        // one instance of a unit box per wall, each just a transform
+        void buildInstancedWalls(Ogre::SceneManager* p_sceneManager);
+
         void buildBall();
 
         Ogre::SceneNode* m_level;
@@ -93,40 +100,16 @@ namespace TiltBall
         Ogre::SceneNode* m_target;
 
         Engine* m_engine;
-        std::string m_name;
-        std::vector<WallCoordinates> m_walls;
-
-        static constexpr float WALL_HEIGHT = 2.0;
-        static constexpr float WALL_HALF_THICKNESS = 0.5;
-        static constexpr float TARGET_HALF_SIZE = 1.5;
-        static constexpr float TARGET_THICKNESS = 0.01;
-
-        float m_extrusion;
-
-        // level dimensions in world coordinates
-        float m_levelYMin;
-        float m_levelYMax;
-        float m_levelXMin;
-        float m_levelXMax;
-        float m_levelZMin;
-        float m_levelZMax;
-
-        float m_targetX;
-        float m_targetZ;
-
-        float m_ballStartingX;
-        float m_ballStartingZ;
-
-        float m_cameraX;
-        float m_cameraY;
-        float m_cameraZ;
+        std::shared_ptr<PreparedLevel> m_preparedLevel;
+        const LevelDescription& m_description;
 
-        std::vector<btCollisionShape*> m_collisionShapes;
-        btRigidBody* m_levelBody;
-        btRigidBody* m_ballBody;
-        btRigidBody* m_targetBody;
+        // null unless the walls are instanced
+        Ogre::InstanceManager* m_wallInstances;
+        Ogre::GpuProgramParametersSharedPtr m_wallParameters;
 
-        std::string m_fileName;
+        // heap object because it has to be built after the scene nodes and
+        // torn down before they are destroyed
+        LevelPhysics* m_physics;
     };
 }
 
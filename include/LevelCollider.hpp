@@ -0,0 +1,105 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LEVELCOLLIDER_HPP
+#define LEVELCOLLIDER_HPP
+
+#include "BoxCoordinates.hpp"
+#include "LevelDescription.hpp"
+#include "LevelGeometry.hpp"
+
+#include <btBulletDynamicsCommon.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct btTriangleInfoMap;
+
+namespace TiltBall
+{
+    // the collision shape of a level's floor and walls, along with
+    // everything it needs to stay valid. it does not belong to any body, so
+    // the same collider can be handed to the physics of a level every time
+    // the level is loaded again
+    class LevelCollider
+    {
+    public:
+        // how the floor and walls are represented for collision detection
+        enum ColliderType
+        {
+            // one box per floor piece and wall
+            COLLIDER_COMPOUND,
+
+            // a single triangle mesh with a quantized BVH
+            COLLIDER_TRIANGLE_MESH
+        };
+
+        // for triangle meshes, p_bvhFileName names a file the BVH is read
+        // from if it holds one for this level file, and written to
+        // otherwise; an empty name always builds the BVH
+        LevelCollider(const LevelDescription& p_description,
+                      ColliderType p_colliderType,
+                      std::string p_bvhFileName);
+
+        LevelCollider(const LevelCollider& p_other) = delete;
+
+        LevelCollider& operator=(const LevelCollider& p_other) = delete;
+
+        ~LevelCollider();
+
+        ColliderType getColliderType() const;
+
+        btCollisionShape* getShape();
+
+    private:
+        btCollisionShape* buildBoxShape(const BoxCoordinates& p_box);
+
+        btTransform buildBoxTransform(const BoxCoordinates& p_box);
+
+        void buildCompoundShape(const LevelDescription& p_description);
+
+        void buildTriangleMeshShape(const LevelDescription& p_description,
+                                    std::string p_bvhFileName);
+
+        // p_levelHash is the hash of the level file, see
+        // LevelDescription::getFileHash()
+        bool loadBvh(std::string p_fileName, uint64_t p_levelHash);
+
+        void saveBvh(std::string p_fileName, uint64_t p_levelHash);
+
+        ColliderType m_colliderType;
+
+        btCollisionShape* m_shape;
+        std::vector<btCollisionShape*> m_childShapes;
+
+        // triangle meshes only; the mesh reads its vertices and indices
+        // straight out of the geometry, so both have to outlive the shape
+        LevelGeometry* m_geometry;
+        btTriangleIndexVertexArray* m_mesh;
+        btTriangleInfoMap* m_triangleInfoMap;
+
+        // a BVH read from a file lives in this buffer rather than being
+        // owned by the shape
+        void* m_bvhBuffer;
+        btOptimizedBvh* m_loadedBvh;
+    };
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LEVELDESCRIPTION_HPP
+#define LEVELDESCRIPTION_HPP
+
+#include "BoxCoordinates.hpp"
+#include "MappedFile.hpp"
+#include "WallCoordinates.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace TiltBall
+{
+    // everything a level file tells us about a level, plus the boxes derived
+    // from it; has no dependencies on Ogre or Bullet so the headless simulator
+    // can use it as well as the game.
+    //
+    // levels are authored as JSON and can be compiled into a binary format
+    // (see saveBinary) which is memory mapped when loaded, with the walls
+    // read straight out of the mapping. walls from JSON are merged on
+    // loading, so binary levels hold them merged already
+    class LevelDescription
+    {
+    public:
+        LevelDescription();
+
+        // loads either format, telling them apart by the binary header
+        void load(std::string p_fileName);
+
+        void saveBinary(std::string p_fileName) const;
+
+        std::string getName() const;
+
+        // hash of the level file's contents, for caching things derived
+        // from the level
+        uint64_t getFileHash() const;
+
+        const WallCoordinates* getWalls() const;
+
+        std::size_t getWallCount() const;
+
+        float getLevelXMin() const;
+
+        float getLevelXMax() const;
+
+        float getLevelYMin() const;
+
+        float getLevelYMax() const;
+
+        float getLevelZMin() const;
+
+        float getLevelZMax() const;
+
+        // target and ball positions in world coordinates
+        float getTargetX() const;
+
+        float getTargetY() const;
+
+        float getTargetZ() const;
+
+        float getBallStartingX() const;
+
+        float getBallStartingY() const;
+
+        float getBallStartingZ() const;
+
+        float getCameraX() const;
+
+        float getCameraY() const;
+
+        float getCameraZ() const;
+
+        std::vector<BoxCoordinates> buildBottomSurfaceBoxes() const;
+
+        // one box per wall, except that walls running along z are cut
+        // where walls running along x cross them so that no two boxes
+        // overlap
+        std::vector<BoxCoordinates> buildWallBoxes() const;
+
+        // target box relative to the target position
+        BoxCoordinates buildTargetBox() const;
+
+        static constexpr float WALL_HEIGHT = 2.0;
+        static constexpr float WALL_HALF_THICKNESS = 0.5;
+        static constexpr float TARGET_HALF_SIZE = 1.5;
+        static constexpr float TARGET_THICKNESS = 0.01;
+        static constexpr float BALL_STARTING_HEIGHT = 4.0;
+
+        static constexpr unsigned int BINARY_VERSION = 2;
+
+    private:
+        void loadJson(const MappedFile& p_file, std::string p_fileName);
+
+        bool loadBinary(std::shared_ptr<MappedFile> p_file);
+
+        // joins collinear walls that touch or overlap into single walls
+        void mergeWalls();
+
+        void setDimensions(float p_dimensionX, float p_dimensionZ);
+
+        void logSummary() const;
+
+        std::string m_name;
+        uint64_t m_fileHash;
+
+        // walls come either from m_walls or, for binary levels, straight
+        // from the mapped file
+        std::vector<WallCoordinates> m_walls;
+        std::shared_ptr<MappedFile> m_mappedFile;
+        const WallCoordinates* m_mappedWalls;
+        std::size_t m_mappedWallCount;
+
+        // level dimensions in world coordinates
+        float m_levelYMin;
+        float m_levelYMax;
+        float m_levelXMin;
+        float m_levelXMax;
+        float m_levelZMin;
+        float m_levelZMax;
+
+        // target and ball coordinates as given in the level file, relative
+        // to the level's minimum corner
+        float m_targetX;
+        float m_targetZ;
+
+        float m_ballStartingX;
+        float m_ballStartingZ;
+
+        float m_cameraX;
+        float m_cameraY;
+        float m_cameraZ;
+    };
+}
+
+#endif
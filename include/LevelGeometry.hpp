@@ -0,0 +1,112 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LEVELGEOMETRY_HPP
+#define LEVELGEOMETRY_HPP
+
+#include "BoxCoordinates.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace TiltBall
+{
+    // gathers level boxes sharing a material into a single vertex and
+    // index list, so the renderer can draw all of them with one call.
+    // faces that coincide with a face of another box are dropped, since
+    // they are either hidden between the two boxes or drawn twice, and
+    // identical vertices are shared between faces
+    class LevelGeometry
+    {
+    public:
+        struct Vertex
+        {
+            float m_position[3];
+            float m_normal[3];
+            float m_textureCoord[2];
+        };
+
+        LevelGeometry();
+
+        LevelGeometry(const LevelGeometry& p_other) = delete;
+
+        LevelGeometry& operator=(const LevelGeometry& p_other) = delete;
+
+        void addBox(const BoxCoordinates& p_box);
+
+        // turns the added boxes into vertices and indices; boxes added
+        // afterwards need another call
+        void build();
+
+        const std::vector<Vertex>& getVertices() const;
+
+        // three per triangle
+        const std::vector<uint32_t>& getIndices() const;
+
+    private:
+        struct Face
+        {
+            Vertex m_corners[4];
+            bool m_hidden;
+        };
+
+        struct FaceKey
+        {
+            float m_corners[12];
+        };
+
+        struct FaceKeyHash
+        {
+            std::size_t operator()(const FaceKey& p_key) const;
+        };
+
+        struct FaceKeyEqual
+        {
+            bool operator()(const FaceKey& p_first, const FaceKey& p_second) const;
+        };
+
+        struct VertexHash
+        {
+            std::size_t operator()(const Vertex& p_vertex) const;
+        };
+
+        struct VertexEqual
+        {
+            bool operator()(const Vertex& p_first, const Vertex& p_second) const;
+        };
+
+        void addFace(const float p_corners[4][3],
+                     const float p_normal[3],
+                     const float p_textureCoords[4][2]);
+
+        std::vector<Face> m_faces;
+
+        // faces by their corner positions regardless of order, to find
+        // coincident ones
+        std::unordered_map<FaceKey, std::size_t, FaceKeyHash, FaceKeyEqual> m_faceIndices;
+
+        std::vector<Vertex> m_vertices;
+        std::vector<uint32_t> m_indices;
+    };
+}
+
+#endif
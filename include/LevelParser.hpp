@@ -0,0 +1,152 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LEVELPARSER_HPP
+#define LEVELPARSER_HPP
+
+#include "WallCoordinates.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace TiltBall
+{
+    class LevelParseError : public std::runtime_error
+    {
+    public:
+        LevelParseError(std::string p_sourceName,
+                        int p_line,
+                        int p_column,
+                        std::string p_message);
+
+        int getLine() const;
+
+        int getColumn() const;
+
+    private:
+        int m_line;
+        int m_column;
+    };
+
+    // single pass parser for JSON level files; reads straight from memory
+    // into the level fields and the wall list without building a document
+    // tree, checks the level schema as it goes and reports the line and
+    // column of anything that does not fit. keys it does not know about
+    // are skipped
+    class LevelParser
+    {
+    public:
+        LevelParser(const char* p_begin, const char* p_end, std::string p_sourceName);
+
+        LevelParser(const LevelParser& p_other) = delete;
+
+        LevelParser& operator=(const LevelParser& p_other) = delete;
+
+        void parse();
+
+        std::string getName() const;
+
+        float getDimensionX() const;
+
+        float getDimensionZ() const;
+
+        float getCameraX() const;
+
+        float getCameraY() const;
+
+        float getCameraZ() const;
+
+        float getTargetX() const;
+
+        float getTargetZ() const;
+
+        float getBallX() const;
+
+        float getBallZ() const;
+
+        // non-const so the walls can be swapped out instead of copied
+        std::vector<WallCoordinates>& getWalls();
+
+    private:
+        void parseLevel();
+
+        void parsePoint(float* p_x, float* p_y, float* p_z);
+
+        void parseWalls();
+
+        void parseWall();
+
+        void parseKey();
+
+        bool isKey(const char* p_key) const;
+
+        std::string parseString();
+
+        double parseNumber();
+
+        // p_depth is the number of arrays and objects already being
+        // skipped around the value, so deeply nested junk fails instead of
+        // overflowing the stack
+        void skipValue(int p_depth);
+
+        void skipString();
+
+        void skipLiteral(const char* p_literal);
+
+        void skipWhitespace();
+
+        bool consume(char p_character);
+
+        void expect(char p_character);
+
+        [[noreturn]] void fail(const char* p_position, std::string p_message) const;
+
+        static constexpr int MAX_SKIP_DEPTH = 64;
+
+        // wall coordinates end up as ints, and floats hold every whole
+        // number up to here exactly
+        static constexpr float MAX_WALL_COORDINATE = 16777216;
+
+        const char* m_begin;
+        const char* m_end;
+        const char* m_position;
+        std::string m_sourceName;
+
+        // the raw text of the key parsed last
+        const char* m_key;
+        std::size_t m_keyLength;
+
+        std::string m_name;
+        float m_dimensionX;
+        float m_dimensionZ;
+        float m_cameraX;
+        float m_cameraY;
+        float m_cameraZ;
+        float m_targetX;
+        float m_targetZ;
+        float m_ballX;
+        float m_ballZ;
+        std::vector<WallCoordinates> m_walls;
+    };
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LEVELPHYSICS_HPP
+#define LEVELPHYSICS_HPP
+
+#include "BoxCoordinates.hpp"
+#include "LevelCollider.hpp"
+#include "LevelDescription.hpp"
+#include "PhysicsWorld.hpp"
+#include "TransformMotionState.hpp"
+
+#include <btBulletDynamicsCommon.h>
+#include <memory>
+#include <vector>
+
+namespace TiltBall
+{
+    // the level, ball and target rigid bodies of a level; knows nothing about
+    // Ogre, the motion states passed in decide what happens with the results
+    class LevelPhysics
+    {
+    public:
+        // takes ownership of the motion states; the level collider may be
+        // shared with other (earlier or later) physics of the same level.
+        // the bodies are tagged, so the physics world can report what the
+        // ball runs into as collision events
+        LevelPhysics(PhysicsWorld* p_physicsWorld,
+                     const LevelDescription& p_description,
+                     std::shared_ptr<LevelCollider> p_levelCollider,
+                     TransformMotionState* p_levelMotionState,
+                     TransformMotionState* p_ballMotionState);
+
+        LevelPhysics(const LevelPhysics& p_other) = delete;
+
+        LevelPhysics& operator=(const LevelPhysics& p_other) = delete;
+
+        ~LevelPhysics();
+
+        btRigidBody* getLevelBody();
+
+        btRigidBody* getBallBody();
+
+        // a trigger rather than a body, the ball passes right into it
+        btPairCachingGhostObject* getTarget();
+
+        // tilts the level (and the target with it) around the world origin
+        void setLevelOrientation(const btQuaternion& p_orientation);
+
+        // puts the level back flat and the ball back at its starting point
+        // at rest, forgetting any contacts and pending collision events;
+        // allocates nothing, so it can be used to respawn the ball
+        void reset();
+
+        static constexpr float BALL_RADIUS = 1.0;
+        static constexpr float BALL_MASS = 50.0;
+
+    private:
+        btCollisionShape* buildBoxShape(const BoxCoordinates& p_box);
+
+        btRigidBody* attachBodyToPhysicsWorld(TransformMotionState* p_motionState,
+                                              btCollisionShape* p_collisionShape,
+                                              float p_mass,
+                                              float p_originX,
+                                              float p_originY,
+                                              float p_originZ,
+                                              PhysicsWorld::BodyTag p_tag);
+
+        void buildLevel(const LevelDescription& p_description,
+                        TransformMotionState* p_levelMotionState);
+
+        void buildBall(const LevelDescription& p_description,
+                       TransformMotionState* p_ballMotionState);
+
+        void placeBody(btRigidBody* p_body, const btTransform& p_transform);
+
+        PhysicsWorld* m_physicsWorld;
+        btDiscreteDynamicsWorld* m_dynamicsWorld;
+
+        std::shared_ptr<LevelCollider> m_levelCollider;
+        std::vector<btCollisionShape*> m_collisionShapes;
+        btRigidBody* m_levelBody;
+        btRigidBody* m_ballBody;
+        btPairCachingGhostObject* m_target;
+
+        btVector3 m_targetPosition;
+        btVector3 m_ballStartingPosition;
+    };
+}
+
+#endif
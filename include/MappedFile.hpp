@@ -0,0 +1,61 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace TiltBall
+{
+    // read only memory mapping of a whole file, unmapped on destruction
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(std::string p_fileName);
+
+        // a part of another mapping, which stays mapped for as long as
+        // the view is around; used for the files in an asset pack
+        MappedFile(std::shared_ptr<const MappedFile> p_parent,
+                   std::size_t p_offset,
+                   std::size_t p_size);
+
+        MappedFile(const MappedFile& p_other) = delete;
+
+        MappedFile& operator=(const MappedFile& p_other) = delete;
+
+        ~MappedFile();
+
+        const char* getData() const;
+
+        std::size_t getSize() const;
+
+    private:
+        const char* m_data;
+        std::size_t m_size;
+
+        // null unless this is a view
+        std::shared_ptr<const MappedFile> m_parent;
+    };
+}
+
+#endif
@@ -26,6 +26,9 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace TiltBall
 {
+    // the menu is built once and kept by the engine (see
+    // Engine::getMenuState), opening and closing it only shows and hides
+    // its windows
     class MenuState: public GameState
     {
     public:
@@ -37,12 +40,23 @@ namespace TiltBall
 
         ~MenuState();
 
+        // before pushing the menu
+        void show();
+
+        // done by the menu itself when it asks to be popped
+        void hide();
+
         void pause();
 
         void resume();
 
+        // the menu only changes when the mouse or keyboard does something
+        bool needsContinuousRendering() const;
+
         bool update(const Ogre::FrameEvent& p_event);
 
+        void simulate(float p_elapsed);
+
         bool mouseMoved(const OIS::MouseEvent& p_evt);
 
         bool mousePressed(const OIS::MouseEvent& p_evt,
@@ -62,6 +76,8 @@ namespace TiltBall
         bool onQuitButtonClicked(const CEGUI::EventArgs& e);
 
         bool m_quit;
+
+        CEGUI::Window* m_sheet;
     };
 }
 
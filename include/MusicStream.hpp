@@ -0,0 +1,91 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MUSICSTREAM_HPP
+#define MUSICSTREAM_HPP
+
+#include "MappedFile.hpp"
+
+#include <AL/al.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <vorbis/vorbisfile.h>
+
+namespace TiltBall
+{
+    // plays an Ogg Vorbis file through a small ring of OpenAL buffers that a
+    // thread of its own decodes into as they finish playing, so only a few
+    // hundred KB of the music are ever decoded at once. the file is decoded
+    // straight from its mapping (or the asset pack's), never read
+    class MusicStream
+    {
+    public:
+        // starts playing right away; OpenAL has to be initialized already
+        MusicStream(std::string p_fileName, float p_gain);
+
+        MusicStream(const MusicStream& p_other) = delete;
+
+        MusicStream& operator=(const MusicStream& p_other) = delete;
+
+        ~MusicStream();
+
+        static constexpr int BUFFER_COUNT = 4;
+        // in bytes, about 0.4 seconds of 44.1 kHz stereo
+        static constexpr int BUFFER_SIZE = 65536;
+        static constexpr int POLL_MILLISECONDS = 50;
+
+    private:
+        void stream();
+
+        // decodes the next part of the file into p_buffer, false once
+        // there is nothing left
+        bool fillBuffer(ALuint p_buffer);
+
+        // vorbisfile reads through these instead of stdio
+        static size_t read(void* p_destination, size_t p_size, size_t p_count, void* p_stream);
+
+        static int seek(void* p_stream, ogg_int64_t p_offset, int p_whence);
+
+        static long tell(void* p_stream);
+
+        std::shared_ptr<MappedFile> m_file;
+        std::size_t m_filePosition;
+
+        OggVorbis_File m_vorbis;
+        ALenum m_format;
+        ALsizei m_rate;
+
+        ALuint m_buffers[BUFFER_COUNT];
+        ALuint m_source;
+
+        std::vector<char> m_pcm;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeUp;
+        bool m_stopping;
+        std::thread m_thread;
+    };
+}
+
+#endif
@@ -18,27 +18,29 @@ You should have received a copy of the GNU General Public License
 along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#ifndef OGREMOTIONSTATE_HPP
+#define OGREMOTIONSTATE_HPP
+
+#include "TransformMotionState.hpp"
+
 #include <btBulletDynamicsCommon.h>
 #include <OGRE/Ogre.h>
 
 namespace TiltBall
 {
-    class OgreMotionState : public btMotionState
+    class OgreMotionState : public TransformMotionState
     {
     public:
-        OgreMotionState(btTransform& p_initialpos,
-                        Ogre::SceneNode* p_node);
+        explicit OgreMotionState(Ogre::SceneNode* p_node);
 
         void setNode(Ogre::SceneNode* p_node);
 
-        void getWorldTransform(btTransform& p_worldTrans) const;
-
-        void setWorldTransform(const btTransform& p_worldTrans);
-
-        void kinematicSetPosition(btTransform& p_worldTrans);
+        // moves the node to where the body is drawn between physics steps
+        void interpolate(btScalar p_alpha);
 
     protected:
         Ogre::SceneNode* m_node;
-        btTransform m_position;
     };
 }
+
+#endif
@@ -0,0 +1,108 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PACKARCHIVE_HPP
+#define PACKARCHIVE_HPP
+
+#include "AssetPack.hpp"
+
+#include <OGRE/Ogre.h>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace TiltBall
+{
+    // one resource group of an asset pack as an Ogre archive. the files
+    // are listed by their names alone, like a non-recursive FileSystem
+    // location, and opened as streams over the pack's mapping without
+    // copying them
+    class PackArchive : public Ogre::Archive
+    {
+    public:
+        PackArchive(const Ogre::String& p_name,
+                    const Ogre::String& p_type,
+                    std::shared_ptr<AssetPack> p_pack,
+                    std::string p_group);
+
+        PackArchive(const PackArchive& p_other) = delete;
+
+        PackArchive& operator=(const PackArchive& p_other) = delete;
+
+        bool isCaseSensitive() const;
+
+        void load();
+
+        void unload();
+
+        Ogre::DataStreamPtr open(const Ogre::String& p_fileName, bool p_readOnly = true) const;
+
+        Ogre::StringVectorPtr list(bool p_recursive = true, bool p_dirs = false);
+
+        Ogre::FileInfoListPtr listFileInfo(bool p_recursive = true, bool p_dirs = false);
+
+        Ogre::StringVectorPtr find(const Ogre::String& p_pattern,
+                                   bool p_recursive = true,
+                                   bool p_dirs = false);
+
+        Ogre::FileInfoListPtr findFileInfo(const Ogre::String& p_pattern,
+                                           bool p_recursive = true,
+                                           bool p_dirs = false) const;
+
+        bool exists(const Ogre::String& p_fileName);
+
+        time_t getModifiedTime(const Ogre::String& p_fileName);
+
+    private:
+        // the path in the pack of a file of the group, empty if there is
+        // no such file
+        std::string findPath(const Ogre::String& p_fileName) const;
+
+        std::shared_ptr<AssetPack> m_pack;
+        std::string m_group;
+
+        // name -> path in the pack, filled by load()
+        std::map<std::string, std::string> m_paths;
+    };
+
+    // creates the archives for locations named "<group>@<pack file>", all
+    // of them sharing the one pack
+    class PackArchiveFactory : public Ogre::ArchiveFactory
+    {
+    public:
+        explicit PackArchiveFactory(std::shared_ptr<AssetPack> p_pack);
+
+        PackArchiveFactory(const PackArchiveFactory& p_other) = delete;
+
+        PackArchiveFactory& operator=(const PackArchiveFactory& p_other) = delete;
+
+        const Ogre::String& getType() const;
+
+        Ogre::Archive* createInstance(const Ogre::String& p_name);
+
+        void destroyInstance(Ogre::Archive* p_archive);
+
+        static const Ogre::String TYPE;
+
+    private:
+        std::shared_ptr<AssetPack> m_pack;
+    };
+}
+
+#endif
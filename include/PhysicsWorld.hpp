@@ -0,0 +1,136 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PHYSICSWORLD_HPP
+#define PHYSICSWORLD_HPP
+
+#include "CollisionEventQueue.hpp"
+#include "FrameProfiler.hpp"
+
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <btBulletDynamicsCommon.h>
+#include <vector>
+
+namespace TiltBall
+{
+    // owns the bullet dynamics world and everything it needs, shared by the
+    // game engine and the headless simulator. physics always advances in
+    // fixed steps no matter how often step() is called; the motion states
+    // interpolate between the last two steps for display
+    class PhysicsWorld
+    {
+    public:
+        // what a body is to the game, kept in its user index so contacts can
+        // be told apart without looking at anything else
+        enum BodyTag
+        {
+            BODY_UNTAGGED = -1,
+            BODY_LEVEL,
+            BODY_BALL,
+            BODY_TARGET,
+            BODY_HAZARD
+        };
+
+        PhysicsWorld();
+
+        PhysicsWorld(const PhysicsWorld& p_other) = delete;
+
+        PhysicsWorld& operator=(const PhysicsWorld& p_other) = delete;
+
+        ~PhysicsWorld();
+
+        btDiscreteDynamicsWorld* getDynamicsWorld();
+
+        // advances the world by p_elapsed seconds of real time, running as
+        // many fixed steps as fit (but no more than the sub step cap) and
+        // carrying the remainder over to the next call
+        void step(float p_elapsed);
+
+        // a frozen world ignores step(), and picks up where it left off
+        // once thawed, without catching up on the time in between
+        void setFrozen(bool p_frozen);
+
+        bool isFrozen() const;
+
+        float getFixedTimeStep() const;
+
+        // times the bullet steps and the motion state updates; null (the
+        // default) to time nothing
+        void setProfiler(FrameProfiler* p_profiler);
+
+        // what happened during the last call to step(), to be handled before
+        // the next one
+        CollisionEventQueue& getCollisionEvents();
+
+        // adds a sensor that only dynamic bodies (the ball) set off; touching
+        // it records an event depending on its tag. does not take ownership
+        void addTrigger(btPairCachingGhostObject* p_trigger, BodyTag p_tag);
+
+        void removeTrigger(btPairCachingGhostObject* p_trigger);
+
+        static void setBodyTag(btCollisionObject* p_body, BodyTag p_tag);
+
+        static BodyTag getBodyTag(const btCollisionObject* p_body);
+
+        static constexpr float DEFAULT_STEP_RATE = 60;
+        static constexpr int DEFAULT_MAX_SUB_STEPS = 5;
+
+    private:
+        void savePreviousPositions();
+
+        void interpolateMotionStates(btScalar p_alpha);
+
+        // runs inside stepSimulation, so it must only record what happened
+        static void tickCallback(btDynamicsWorld* p_world, btScalar p_timeStep);
+
+        void recordCollisionEvents();
+
+        void recordWallImpact(btPersistentManifold* p_manifold,
+                              const btCollisionObject* p_levelBody);
+
+        bool isTriggerTouched(btPairCachingGhostObject* p_trigger);
+
+        static constexpr float GRAVITY = -250;
+
+        // contacts whose normal is closer than this to the level's up axis
+        // are on the floor, the rest are against a wall
+        static constexpr float WALL_NORMAL_LIMIT = 0.5;
+
+        btDefaultCollisionConfiguration* m_collisionConfiguration;
+        btCollisionDispatcher* m_dispatcher;
+        btBroadphaseInterface* m_broadphase;
+        btConstraintSolver* m_solver;
+        btDiscreteDynamicsWorld* m_dynamicsWorld;
+        btGhostPairCallback* m_ghostPairCallback;
+
+        float m_fixedTimeStep;
+        int m_maxSubSteps;
+        float m_accumulator;
+        bool m_frozen;
+
+        FrameProfiler* m_profiler;
+
+        std::vector<btPairCachingGhostObject*> m_triggers;
+        btManifoldArray m_triggerManifolds;
+        CollisionEventQueue m_collisionEvents;
+    };
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PREPAREDLEVEL_HPP
+#define PREPAREDLEVEL_HPP
+
+#include "BoxCoordinates.hpp"
+#include "ColliderCache.hpp"
+#include "LevelCollider.hpp"
+#include "LevelDescription.hpp"
+#include "LevelGeometry.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TiltBall
+{
+    // everything about a level that can be worked out without Ogre or the
+    // dynamics world: the description, the vertices and indices of its
+    // geometry and its collider. being independent of both, it can be
+    // prepared on a worker thread while another level is being played,
+    // leaving only the registration with Ogre and Bullet to Level
+    class PreparedLevel
+    {
+    public:
+        // the collider cache has to be safe to use from the calling thread.
+        // without wall geometry the walls are only kept as boxes, for
+        // drawing them as instances of a single box
+        PreparedLevel(std::string p_fileName,
+                      LevelCollider::ColliderType p_colliderType,
+                      ColliderCache* p_colliderCache,
+                      bool p_wallGeometry);
+
+        PreparedLevel(const PreparedLevel& p_other) = delete;
+
+        PreparedLevel& operator=(const PreparedLevel& p_other) = delete;
+
+        std::string getFileName() const;
+
+        const LevelDescription& getDescription() const;
+
+        const LevelGeometry& getBottomSurface() const;
+
+        bool hasWallGeometry() const;
+
+        // empty without wall geometry
+        const LevelGeometry& getWalls() const;
+
+        const std::vector<BoxCoordinates>& getWallBoxes() const;
+
+        // relative to the target position
+        const LevelGeometry& getTarget() const;
+
+        std::shared_ptr<LevelCollider> getCollider() const;
+
+    private:
+        std::string m_fileName;
+        LevelDescription m_description;
+
+        LevelGeometry m_bottomSurface;
+        bool m_wallGeometry;
+        LevelGeometry m_walls;
+        std::vector<BoxCoordinates> m_wallBoxes;
+        LevelGeometry m_target;
+
+        std::shared_ptr<LevelCollider> m_collider;
+    };
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILEROVERLAY_HPP
+#define PROFILEROVERLAY_HPP
+
+#include "FrameProfiler.hpp"
+
+#include <OGRE/Ogre.h>
+#include <string>
+
+namespace TiltBall
+{
+    // shows the p50/p95/p99 frame timings of a profiler in a corner of
+    // the screen, and writes them out on request
+    class ProfilerOverlay
+    {
+    public:
+        explicit ProfilerOverlay(FrameProfiler* p_profiler);
+
+        ProfilerOverlay(const ProfilerOverlay& p_other) = delete;
+
+        ProfilerOverlay& operator=(const ProfilerOverlay& p_other) = delete;
+
+        void toggle();
+
+        // call once a frame; refreshes the numbers every REFRESH_FRAMES
+        // frames while the overlay is shown
+        void update();
+
+        // writes p_baseName.csv and p_baseName.json
+        void dump(std::string p_baseName);
+
+        static constexpr int REFRESH_FRAMES = 30;
+
+    private:
+        void refresh();
+
+        FrameProfiler* m_profiler;
+        Ogre::Overlay* m_overlay;
+        // the font is not monospaced, so each column is a text area of its own
+        Ogre::OverlayElement* m_columns[4];
+        int m_framesUntilRefresh;
+    };
+}
+
+#endif
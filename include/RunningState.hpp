@@ -23,6 +23,11 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Engine.hpp"
 #include "GameState.hpp"
+#include "PreparedLevel.hpp"
+
+#include <future>
+#include <memory>
+#include <string>
 
 namespace TiltBall
 {
@@ -39,12 +44,18 @@ namespace TiltBall
 
         ~RunningState();
 
+        // the ball stays where it is while the menu is open
         void pause();
 
         void resume();
 
+        // nothing moves while paused, so one frame is enough
+        PausedRendering getPausedRendering() const;
+
         bool update(const Ogre::FrameEvent& p_event);
 
+        void simulate(float p_elapsed);
+
         bool mouseMoved(const OIS::MouseEvent& evt);
 
         bool mousePressed(const OIS::MouseEvent& evt, OIS::MouseButtonID);
@@ -55,14 +66,24 @@ namespace TiltBall
 
         bool keyReleased(const OIS::KeyEvent& evt);
 
-        void loadNextLevel();
+        // called once the ball reached the target; the next level is
+        // swapped in on the next update
+        void completeLevel();
 
-        void reloadCurrentLevel();
+        void loadNextLevel();
 
     private:
+        // prepares the level after the current one on a worker thread
+        void startPreloading();
+
         // heap object because we will want to allocate and destroy Level objects as we go from
         // level to level in the game
         Level* m_currentLevel;
+
+        // null once prepared if there is no next level
+        std::future<std::shared_ptr<PreparedLevel>> m_nextLevel;
+
+        bool m_levelCompleted;
     };
 }
 
@@ -0,0 +1,99 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include "LevelDescription.hpp"
+#include "LevelPhysics.hpp"
+#include "PhysicsWorld.hpp"
+#include "TiltScript.hpp"
+
+#include <btBulletDynamicsCommon.h>
+#include <ostream>
+#include <string>
+
+namespace TiltBall
+{
+    // runs the physics of a level without any graphics, input or audio,
+    // tilting the level according to a script instead of mouse input
+    class Simulation
+    {
+    public:
+        enum Outcome
+        {
+            OUTCOME_TIMED_OUT,
+            OUTCOME_TARGET_REACHED,
+            OUTCOME_BALL_FELL_OFF
+        };
+
+        Simulation(std::string p_levelFileName,
+                   const TiltScript& p_script,
+                   LevelCollider::ColliderType p_colliderType);
+
+        Simulation(const Simulation& p_other) = delete;
+
+        Simulation& operator=(const Simulation& p_other) = delete;
+
+        ~Simulation();
+
+        // steps the simulation until something happens to the ball or the
+        // given amount of simulated time runs out
+        Outcome run(float p_maxSeconds);
+
+        // advances the simulation by exactly one fixed time step
+        void step();
+
+        // back to the state right after loading, without loading again
+        void reset();
+
+        int getStepCount() const;
+
+        float getSimulatedTime() const;
+
+        btVector3 getBallPosition();
+
+        int getWallImpactCount() const;
+
+        // writes every collision event to p_stream as it is handled, null
+        // to stop; does not take ownership
+        void setEventLog(std::ostream* p_stream);
+
+    private:
+        // goes through the collision events of the last step
+        bool isBallOnTarget();
+
+        PhysicsWorld m_physicsWorld;
+        LevelDescription m_description;
+
+        // heap object because it can only be built once the description
+        // has been loaded
+        LevelPhysics* m_levelPhysics;
+
+        TiltScript m_script;
+        btQuaternion m_levelOrientation;
+
+        int m_stepCount;
+        int m_wallImpactCount;
+        std::ostream* m_eventLog;
+    };
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SYNCHRONIZEDSTREAMBUFFER_HPP
+#define SYNCHRONIZEDSTREAMBUFFER_HPP
+
+#include <mutex>
+#include <streambuf>
+#include <string>
+
+namespace TiltBall
+{
+    // collects what each thread writes to it until the end of a line (or
+    // a flush) and then passes the whole line on to another stream buffer
+    // while holding a lock, so that a log stream can be shared with worker
+    // threads without their lines running into each other
+    class SynchronizedStreamBuffer : public std::streambuf
+    {
+    public:
+        explicit SynchronizedStreamBuffer(std::streambuf* p_target);
+
+        SynchronizedStreamBuffer(const SynchronizedStreamBuffer& p_other) = delete;
+
+        SynchronizedStreamBuffer& operator=(const SynchronizedStreamBuffer& p_other) = delete;
+
+    protected:
+        int overflow(int p_character);
+
+        std::streamsize xsputn(const char* p_data, std::streamsize p_size);
+
+        int sync();
+
+    private:
+        // the text the calling thread has written since its last line
+        std::string& getPendingText();
+
+        // writes the calling thread's pending text to the target
+        bool writePendingText(std::string& p_text);
+
+        std::streambuf* m_target;
+        std::mutex m_mutex;
+    };
+}
+
+#endif
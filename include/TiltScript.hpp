@@ -0,0 +1,64 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TILTSCRIPT_HPP
+#define TILTSCRIPT_HPP
+
+#include <string>
+#include <vector>
+
+namespace TiltBall
+{
+    // scripted tilt input for the headless simulator; a script file has one
+    // "<seconds> <roll degrees per second> <pitch degrees per second>" entry
+    // per line, the entries are played back one after another
+    class TiltScript
+    {
+    public:
+        TiltScript();
+
+        void load(std::string p_fileName);
+
+        // adds an entry after the last one
+        void append(float p_seconds, float p_rollRate, float p_pitchRate);
+
+        float getDuration() const;
+
+        // tilt rates at the given time from the start of the script, zero
+        // once the script has run out
+        float getRollRate(float p_time) const;
+
+        float getPitchRate(float p_time) const;
+
+    private:
+        struct Entry
+        {
+            float m_endTime;
+            float m_rollRate;
+            float m_pitchRate;
+        };
+
+        const Entry* findEntry(float p_time) const;
+
+        std::vector<Entry> m_entries;
+    };
+}
+
+#endif
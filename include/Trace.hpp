@@ -0,0 +1,91 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace TiltBall
+{
+    // records named zones of time per thread and writes them out in the
+    // Chrome trace event format (chrome://tracing, Perfetto). each thread
+    // writes to a ring buffer of its own without taking any lock; the
+    // oldest zones are overwritten once it is full
+    class Trace
+    {
+    public:
+        static void setEnabled(bool p_enabled);
+
+        static bool isEnabled()
+        {
+            return s_enabled.load(std::memory_order_relaxed);
+        }
+
+        // p_name has to live as long as the trace, a string literal
+        static void record(const char* p_name,
+                           std::chrono::steady_clock::time_point p_start,
+                           std::chrono::steady_clock::time_point p_end);
+
+        // everything still in the buffers of all threads, alive or not
+        static void write(std::ostream& p_stream);
+
+        static void writeFile(std::string p_fileName);
+
+        // zones per thread
+        static constexpr int BUFFER_CAPACITY = 1 << 14;
+
+    private:
+        static std::atomic<bool> s_enabled;
+    };
+
+    // traces the time from construction to destruction; when tracing is
+    // off all it costs is a branch
+    class TraceZone
+    {
+    public:
+        explicit TraceZone(const char* p_name) :
+            m_name(Trace::isEnabled() ? p_name : 0)
+        {
+            if(m_name)
+                m_start = std::chrono::steady_clock::now();
+        }
+
+        TraceZone(const TraceZone& p_other) = delete;
+
+        TraceZone& operator=(const TraceZone& p_other) = delete;
+
+        ~TraceZone()
+        {
+            if(m_name)
+                Trace::record(m_name, m_start, std::chrono::steady_clock::now());
+        }
+
+    private:
+        const char* m_name;
+        std::chrono::steady_clock::time_point m_start;
+    };
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRANSFORMMOTIONSTATE_HPP
+#define TRANSFORMMOTIONSTATE_HPP
+
+#include <btBulletDynamicsCommon.h>
+
+namespace TiltBall
+{
+    // motion state which only keeps track of a body's transform; used as is
+    // by the headless simulator, the game extends it to move scene nodes.
+    // also remembers the transform from before the last physics step so
+    // the transform can be interpolated between fixed physics steps
+    class TransformMotionState : public btMotionState
+    {
+    public:
+        TransformMotionState();
+
+        virtual ~TransformMotionState();
+
+        void getWorldTransform(btTransform& p_worldTrans) const;
+
+        virtual void setWorldTransform(const btTransform& p_worldTrans);
+
+        void kinematicSetPosition(const btTransform& p_worldTrans);
+
+        // called by PhysicsWorld right before each fixed step
+        void savePreviousPosition();
+
+        // p_alpha is how far we are between the previous and the current
+        // step, 0 being the previous and 1 the current one
+        btTransform getInterpolatedTransform(btScalar p_alpha) const;
+
+        // called by PhysicsWorld once per frame after stepping; does nothing
+        // here, subclasses use it to present the interpolated transform
+        virtual void interpolate(btScalar p_alpha);
+
+    protected:
+        btTransform m_position;
+        btTransform m_previousPosition;
+    };
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VOICEPOOL_HPP
+#define VOICEPOOL_HPP
+
+#include <AL/al.h>
+#include <vector>
+
+namespace TiltBall
+{
+    // a fixed set of OpenAL sources shared by all sound effects; when every
+    // one of them is busy, a new sound takes over the oldest voice playing
+    // something no more important than itself
+    class VoicePool
+    {
+    public:
+        explicit VoicePool(int p_voiceCount);
+
+        VoicePool(const VoicePool& p_other) = delete;
+
+        VoicePool& operator=(const VoicePool& p_other) = delete;
+
+        ~VoicePool();
+
+        // false if every voice is busy with something more important
+        bool play(ALuint p_buffer, int p_priority, float p_gain, float p_pitch);
+
+        // voices playing a sound of exactly p_priority
+        int countPlaying(int p_priority);
+
+    private:
+        struct Voice
+        {
+            ALuint m_source;
+            int m_priority;
+            // when the voice was last started, in plays through the pool
+            unsigned long m_started;
+        };
+
+        bool isPlaying(const Voice& p_voice);
+
+        std::vector<Voice> m_voices;
+        unsigned long m_playCount;
+    };
+}
+
+#endif
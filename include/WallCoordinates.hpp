@@ -21,8 +21,6 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef WALLCOORDINATES_HPP
 #define	WALLCOORDINATES_HPP
 
-#include <OGRE/Ogre.h>
-
 namespace TiltBall
 {
     class WallCoordinates
@@ -33,13 +31,13 @@ namespace TiltBall
                         int p_endX,
                         int p_endZ);
 
-        int getBeginX();
+        int getBeginX() const;
 
-        int getBeginZ();
+        int getBeginZ() const;
 
-        int getEndX();
+        int getEndX() const;
 
-        int getEndZ();
+        int getEndZ() const;
 
     private:
         int m_beginX;
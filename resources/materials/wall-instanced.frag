@@ -0,0 +1,11 @@
+#version 120
+
+uniform sampler2D wallTexture;
+uniform vec4 ambient;
+
+varying vec2 textureCoord;
+
+void main()
+{
+    gl_FragColor = texture2D(wallTexture, textureCoord) * ambient;
+}
@@ -0,0 +1,46 @@
+#version 120
+
+// walls drawn as instances of a single unit box; Ogre hands each instance
+// its 3x4 transform relative to the level in uv1 to uv3
+
+attribute vec4 vertex;
+attribute vec3 normal;
+attribute vec4 uv0;
+attribute vec4 uv1;
+attribute vec4 uv2;
+attribute vec4 uv3;
+
+uniform mat4 viewProjMatrix;
+uniform mat4 levelMatrix;
+uniform float textureScale;
+
+varying vec2 textureCoord;
+
+void main()
+{
+    mat4 instanceMatrix;
+    instanceMatrix[0] = uv1;
+    instanceMatrix[1] = uv2;
+    instanceMatrix[2] = uv3;
+    instanceMatrix[3] = vec4(0.0, 0.0, 0.0, 1.0);
+
+    gl_Position = viewProjMatrix * (levelMatrix * (vertex * instanceMatrix));
+
+    // walls are only scaled along the level axes, so the length of each
+    // column is the size of the wall along that axis
+    vec3 size = vec3(length(vec3(uv1.x, uv2.x, uv3.x)),
+                     length(vec3(uv1.y, uv2.y, uv3.y)),
+                     length(vec3(uv1.z, uv2.z, uv3.z)));
+
+    // same layout as LevelGeometry::addBox, the coordinates of a face
+    // span its size in level units
+    vec2 faceSize;
+    if(abs(normal.y) > 0.5)
+        faceSize = size.xz;
+    else if(abs(normal.z) > 0.5)
+        faceSize = size.xy;
+    else
+        faceSize = size.yz;
+
+    textureCoord = uv0.xy * faceSize / textureScale;
+}
@@ -0,0 +1,291 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "AssetManifest.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <boost/regex.hpp>
+
+namespace TiltBall
+{
+    // how assets name the files they need. a null group means the file is
+    // in the same group as the asset referencing it; the others are the
+    // groups Engine gives each type of CEGUI resource
+    struct ReferenceRule
+    {
+        const char* m_extension;
+        const char* m_pattern;
+        const char* m_group;
+    };
+
+    static const ReferenceRule REFERENCE_RULES[] =
+    {
+        {".scheme", "<Imageset\\s+Filename=\"([^\"]+)\"", "Imagesets"},
+        {".scheme", "<Font\\s+Filename=\"([^\"]+)\"", "Fonts"},
+        {".scheme", "<LookNFeel\\s+Filename=\"([^\"]+)\"", "LookAndFeel"},
+        {".imageset", "Imagefile=\"([^\"]+)\"", 0},
+        {".font", "Filename=\"([^\"]+)\"", 0},
+        {".material", "^\\s*(?:texture|source)\\s+(\\S+)", 0},
+        {".fontdef", "^\\s*source\\s+(\\S+)", 0}
+    };
+
+    static bool endsWith(const std::string& p_string, const std::string& p_suffix)
+    {
+        return p_string.size() >= p_suffix.size() &&
+            p_string.compare(p_string.size() - p_suffix.size(), p_suffix.size(), p_suffix) == 0;
+    }
+
+    static std::string readFile(std::string p_fileName)
+    {
+        std::ifstream stream(p_fileName.c_str(), std::ios::binary);
+        if(!stream.good())
+            throw std::runtime_error("Could not open " + p_fileName);
+
+        std::ostringstream contents;
+        contents << stream.rdbuf();
+        return contents.str();
+    }
+
+    AssetManifest::AssetManifest()
+    {
+    }
+
+    void AssetManifest::load(std::string p_fileName)
+    {
+        std::ifstream stream(p_fileName.c_str());
+        if(!stream.good())
+            throw std::runtime_error("Could not open " + p_fileName);
+
+        m_assets.clear();
+
+        std::string line;
+        int lineNumber = 0;
+        while(std::getline(stream, line))
+        {
+            lineNumber++;
+
+            if(line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream fields(line);
+            Asset asset;
+            if(!(fields >> asset.m_group >> asset.m_path))
+            {
+                std::ostringstream message;
+                message << p_fileName << ":" << lineNumber << ": expected a group and a path";
+                throw std::runtime_error(message.str());
+            }
+
+            m_assets.push_back(asset);
+        }
+    }
+
+    void AssetManifest::save(std::string p_fileName) const
+    {
+        std::ofstream stream(p_fileName.c_str());
+        if(!stream.good())
+            throw std::runtime_error("Could not open " + p_fileName);
+
+        stream << "# generated by tilt-ball-asset-manifest, do not edit" << std::endl;
+        for(auto it = m_assets.begin(); it < m_assets.end(); it++)
+            stream << it->m_group << " " << it->m_path << std::endl;
+
+        if(!stream.good())
+            throw std::runtime_error("Could not write " + p_fileName);
+    }
+
+    void AssetManifest::generate(std::string p_rootsFileName, std::string p_resourceDirectory)
+    {
+        std::ifstream stream(p_rootsFileName.c_str());
+        if(!stream.good())
+            throw std::runtime_error("Could not open " + p_rootsFileName);
+
+        m_assets.clear();
+
+        std::vector<SearchDirectory> searchDirectories;
+        std::vector<Asset> roots;
+
+        std::string line;
+        int lineNumber = 0;
+        while(std::getline(stream, line))
+        {
+            lineNumber++;
+
+            if(line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream fields(line);
+            std::string kind;
+            std::string group;
+            std::string name;
+            if(!(fields >> kind >> group >> name) || (kind != "search" && kind != "root"))
+            {
+                std::ostringstream message;
+                message << p_rootsFileName << ":" << lineNumber
+                        << ": expected search or root, a group and a name";
+                throw std::runtime_error(message.str());
+            }
+
+            if(kind == "search")
+            {
+                SearchDirectory searchDirectory;
+                searchDirectory.m_group = group;
+                searchDirectory.m_directory = name;
+                searchDirectories.push_back(searchDirectory);
+            }
+            else
+            {
+                Asset root;
+                root.m_group = group;
+                root.m_path = name;
+                roots.push_back(root);
+            }
+        }
+
+        for(auto it = roots.begin(); it < roots.end(); it++)
+            addAsset(it->m_group, it->m_path, p_rootsFileName, searchDirectories, p_resourceDirectory);
+
+        // assets added while scanning are scanned in turn, since m_assets
+        // grows as we go it is walked by index
+        for(std::size_t i = 0; i < m_assets.size(); i++)
+        {
+            std::string path = m_assets[i].m_path;
+            std::string group = m_assets[i].m_group;
+
+            std::string contents;
+            for(auto rule = std::begin(REFERENCE_RULES); rule < std::end(REFERENCE_RULES); rule++)
+            {
+                if(!endsWith(path, rule->m_extension))
+                    continue;
+
+                if(contents.empty())
+                    contents = readFile(p_resourceDirectory + "/" + path);
+
+                boost::regex pattern(rule->m_pattern);
+                boost::sregex_iterator match(contents.begin(), contents.end(), pattern);
+                for(; match != boost::sregex_iterator(); match++)
+                {
+                    addAsset(rule->m_group ? rule->m_group : group,
+                             (*match)[1],
+                             path,
+                             searchDirectories,
+                             p_resourceDirectory);
+                }
+            }
+        }
+
+        std::sort(m_assets.begin(), m_assets.end(),
+                  [](const Asset& p_first, const Asset& p_second)
+                  {
+                      if(p_first.m_group != p_second.m_group)
+                          return p_first.m_group < p_second.m_group;
+                      return p_first.m_path < p_second.m_path;
+                  });
+    }
+
+    void AssetManifest::addAsset(std::string p_group,
+                                 std::string p_name,
+                                 std::string p_referrer,
+                                 const std::vector<SearchDirectory>& p_searchDirectories,
+                                 std::string p_resourceDirectory)
+    {
+        // neither the pack nor the directory locations (which are not
+        // recursive) know about subdirectories, Ogre looks up bare names
+        if(p_name.find('/') != std::string::npos)
+            throw std::runtime_error(p_name + " (referenced by " + p_referrer +
+                                     ") must be a bare file name");
+
+        std::string path;
+        for(auto it = p_searchDirectories.begin(); it < p_searchDirectories.end(); it++)
+        {
+            if(it->m_group != p_group)
+                continue;
+
+            std::string candidate = it->m_directory + "/" + p_name;
+
+            struct stat status;
+            if(stat((p_resourceDirectory + "/" + candidate).c_str(), &status) < 0 ||
+               !S_ISREG(status.st_mode))
+                continue;
+
+            // the pack would hold the first, the directories both
+            if(!path.empty())
+                throw std::runtime_error(p_name + " is in both " + path + " and " + candidate +
+                                         " of group " + p_group);
+
+            path = candidate;
+        }
+
+        if(path.empty())
+            throw std::runtime_error(p_name + " (referenced by " + p_referrer +
+                                     ") is not in any directory of group " + p_group);
+
+        for(auto asset = m_assets.begin(); asset < m_assets.end(); asset++)
+        {
+            if(asset->m_group == p_group && asset->m_path == path)
+                return;
+        }
+
+        Asset asset;
+        asset.m_group = p_group;
+        asset.m_path = path;
+        m_assets.push_back(asset);
+    }
+
+    const std::vector<AssetManifest::Asset>& AssetManifest::getAssets() const
+    {
+        return m_assets;
+    }
+
+    std::vector<std::string> AssetManifest::getGroups() const
+    {
+        std::vector<std::string> groups;
+        for(auto it = m_assets.begin(); it < m_assets.end(); it++)
+        {
+            if(std::find(groups.begin(), groups.end(), it->m_group) == groups.end())
+                groups.push_back(it->m_group);
+        }
+
+        return groups;
+    }
+
+    std::vector<std::string> AssetManifest::getDirectories(std::string p_group) const
+    {
+        std::vector<std::string> directories;
+        for(auto it = m_assets.begin(); it < m_assets.end(); it++)
+        {
+            if(it->m_group != p_group)
+                continue;
+
+            std::string directory;
+            std::string::size_type slash = it->m_path.rfind('/');
+            if(slash != std::string::npos)
+                directory = it->m_path.substr(0, slash);
+
+            if(std::find(directories.begin(), directories.end(), directory) == directories.end())
+                directories.push_back(directory);
+        }
+
+        return directories;
+    }
+}
@@ -0,0 +1,297 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "AssetPack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <utility>
+
+namespace TiltBall
+{
+    // a pack starts with this header, followed by an entry per asset, the
+    // group names and paths the entries point at and then the contents of
+    // the files, each aligned to DATA_ALIGNMENT; like binary levels it is
+    // in the byte order of the machine that wrote it
+    struct PackHeader
+    {
+        char m_magic[4];
+        uint32_t m_version;
+        uint32_t m_entryCount;
+        uint32_t m_stringsSize;
+    };
+
+    // string offsets are relative to the start of the strings, data
+    // offsets to the start of the pack
+    struct PackEntry
+    {
+        uint32_t m_groupOffset;
+        uint32_t m_groupLength;
+        uint32_t m_pathOffset;
+        uint32_t m_pathLength;
+        uint64_t m_dataOffset;
+        uint64_t m_dataSize;
+    };
+
+    static const char PACK_MAGIC[4] = { 'T', 'B', 'P', 'K' };
+
+    static uint64_t alignData(uint64_t p_size)
+    {
+        return (p_size + AssetPack::DATA_ALIGNMENT - 1) / AssetPack::DATA_ALIGNMENT *
+            AssetPack::DATA_ALIGNMENT;
+    }
+
+    static std::mutex s_mountsMutex;
+    static std::vector<std::pair<std::string, std::shared_ptr<AssetPack>>> s_mounts;
+
+    AssetPack::AssetPack(std::string p_fileName) :
+        m_file(std::make_shared<MappedFile>(p_fileName))
+    {
+        const char* data = m_file->getData();
+        std::size_t size = m_file->getSize();
+
+        if(size < sizeof(PackHeader) || std::memcmp(data, PACK_MAGIC, 4) != 0)
+            throw std::runtime_error(p_fileName + " is not an asset pack");
+
+        const PackHeader* header = reinterpret_cast<const PackHeader*>(data);
+
+        if(header->m_version != AssetPack::VERSION)
+            throw std::runtime_error("Unsupported asset pack version in " + p_fileName);
+
+        std::size_t stringsOffset = sizeof(PackHeader) + header->m_entryCount * sizeof(PackEntry);
+        if(size < stringsOffset || size - stringsOffset < header->m_stringsSize)
+            throw std::runtime_error("Truncated asset pack " + p_fileName);
+
+        const PackEntry* entries = reinterpret_cast<const PackEntry*>(data + sizeof(PackHeader));
+        const char* strings = data + stringsOffset;
+
+        for(uint32_t i = 0; i < header->m_entryCount; i++)
+        {
+            const PackEntry& packEntry = entries[i];
+
+            if(packEntry.m_groupOffset + packEntry.m_groupLength > header->m_stringsSize ||
+               packEntry.m_pathOffset + packEntry.m_pathLength > header->m_stringsSize ||
+               packEntry.m_dataOffset > size || packEntry.m_dataSize > size - packEntry.m_dataOffset)
+                throw std::runtime_error("Corrupt entry in asset pack " + p_fileName);
+
+            Entry entry;
+            entry.m_group.assign(strings + packEntry.m_groupOffset, packEntry.m_groupLength);
+            entry.m_offset = packEntry.m_dataOffset;
+            entry.m_size = packEntry.m_dataSize;
+
+            m_entries.insert(std::make_pair(std::string(strings + packEntry.m_pathOffset,
+                                                        packEntry.m_pathLength),
+                                            entry));
+        }
+
+        std::clog << "Mapped asset pack " << p_fileName << " (" << m_entries.size()
+                  << " entries, " << size << " bytes)" << std::endl;
+    }
+
+    std::vector<std::string> AssetPack::getGroups() const
+    {
+        std::vector<std::string> groups;
+        for(auto it = m_entries.begin(); it != m_entries.end(); it++)
+        {
+            if(std::find(groups.begin(), groups.end(), it->second.m_group) == groups.end())
+                groups.push_back(it->second.m_group);
+        }
+
+        return groups;
+    }
+
+    std::vector<std::string> AssetPack::getPaths(std::string p_group) const
+    {
+        std::vector<std::string> paths;
+        for(auto it = m_entries.begin(); it != m_entries.end(); it++)
+        {
+            if(it->second.m_group == p_group)
+                paths.push_back(it->first);
+        }
+
+        return paths;
+    }
+
+    std::shared_ptr<MappedFile> AssetPack::open(std::string p_path) const
+    {
+        auto it = m_entries.find(p_path);
+        if(it == m_entries.end())
+            return std::shared_ptr<MappedFile>();
+
+        return std::make_shared<MappedFile>(m_file, it->second.m_offset, it->second.m_size);
+    }
+
+    bool AssetPack::contains(std::string p_path) const
+    {
+        return m_entries.find(p_path) != m_entries.end();
+    }
+
+    void AssetPack::write(const std::vector<AssetManifest::Asset>& p_assets,
+                          std::string p_resourceDirectory,
+                          std::string p_fileName)
+    {
+        std::string strings;
+        std::vector<PackEntry> entries;
+
+        // where each path's contents go, so files in several groups are
+        // only stored once
+        std::map<std::string, std::pair<uint64_t, uint64_t>> dataOffsets;
+        std::vector<std::string> dataPaths;
+
+        uint64_t dataSize = 0;
+        for(auto it = p_assets.begin(); it < p_assets.end(); it++)
+        {
+            if(dataOffsets.find(it->m_path) == dataOffsets.end())
+            {
+                std::string fileName = p_resourceDirectory + "/" + it->m_path;
+                std::ifstream stream(fileName.c_str(), std::ios::binary | std::ios::ate);
+                if(!stream.good())
+                    throw std::runtime_error("Could not open " + fileName);
+
+                uint64_t size = stream.tellg();
+                dataOffsets[it->m_path] = std::make_pair(dataSize, size);
+                dataPaths.push_back(it->m_path);
+
+                dataSize += alignData(size);
+            }
+
+            PackEntry entry;
+            entry.m_groupOffset = strings.size();
+            entry.m_groupLength = it->m_group.size();
+            strings += it->m_group;
+            entry.m_pathOffset = strings.size();
+            entry.m_pathLength = it->m_path.size();
+            strings += it->m_path;
+            entries.push_back(entry);
+        }
+
+        uint64_t indexSize = sizeof(PackHeader) + entries.size() * sizeof(PackEntry) +
+            strings.size();
+        uint64_t dataStart = alignData(indexSize);
+
+        for(std::size_t i = 0; i < entries.size(); i++)
+        {
+            const std::pair<uint64_t, uint64_t>& data = dataOffsets[p_assets[i].m_path];
+            entries[i].m_dataOffset = dataStart + data.first;
+            entries[i].m_dataSize = data.second;
+        }
+
+        PackHeader header;
+        std::memcpy(header.m_magic, PACK_MAGIC, 4);
+        header.m_version = AssetPack::VERSION;
+        header.m_entryCount = entries.size();
+        header.m_stringsSize = strings.size();
+
+        std::ofstream stream(p_fileName.c_str(), std::ios::binary | std::ios::trunc);
+        if(!stream.good())
+            throw std::runtime_error("Could not open " + p_fileName + " for writing");
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if(!entries.empty())
+            stream.write(reinterpret_cast<const char*>(&entries[0]),
+                         entries.size() * sizeof(PackEntry));
+        stream.write(strings.data(), strings.size());
+
+        std::vector<char> padding(AssetPack::DATA_ALIGNMENT, 0);
+        stream.write(&padding[0], dataStart - indexSize);
+
+        for(auto it = dataPaths.begin(); it < dataPaths.end(); it++)
+        {
+            uint64_t size = dataOffsets[*it].second;
+
+            std::string fileName = p_resourceDirectory + "/" + *it;
+            std::ifstream file(fileName.c_str(), std::ios::binary);
+            if(!file.good())
+                throw std::runtime_error("Could not open " + fileName);
+
+            // copying an empty stream buffer counts as a failed write
+            if(size > 0)
+                stream << file.rdbuf();
+
+            stream.write(&padding[0], alignData(size) - size);
+        }
+
+        if(!stream.good())
+            throw std::runtime_error("Could not write " + p_fileName);
+    }
+
+    void AssetPack::mount(std::string p_directory, std::shared_ptr<AssetPack> p_pack)
+    {
+        std::lock_guard<std::mutex> lock(s_mountsMutex);
+        s_mounts.push_back(std::make_pair(p_directory, p_pack));
+    }
+
+    std::shared_ptr<AssetPack> AssetPack::getMounted(std::string p_directory)
+    {
+        std::lock_guard<std::mutex> lock(s_mountsMutex);
+        for(auto it = s_mounts.begin(); it < s_mounts.end(); it++)
+        {
+            if(it->first == p_directory)
+                return it->second;
+        }
+
+        return std::shared_ptr<AssetPack>();
+    }
+
+    std::shared_ptr<AssetPack> AssetPack::findMount(std::string p_fileName, std::string& p_path)
+    {
+        std::lock_guard<std::mutex> lock(s_mountsMutex);
+        for(auto it = s_mounts.begin(); it < s_mounts.end(); it++)
+        {
+            std::string prefix = it->first + "/";
+            if(p_fileName.compare(0, prefix.size(), prefix) == 0)
+            {
+                p_path = p_fileName.substr(prefix.size());
+                return it->second;
+            }
+        }
+
+        return std::shared_ptr<AssetPack>();
+    }
+
+    std::shared_ptr<MappedFile> AssetPack::openFile(std::string p_fileName)
+    {
+        std::string path;
+        std::shared_ptr<AssetPack> pack = findMount(p_fileName, path);
+        if(pack)
+        {
+            std::shared_ptr<MappedFile> file = pack->open(path);
+            if(file)
+                return file;
+        }
+
+        return std::make_shared<MappedFile>(p_fileName);
+    }
+
+    bool AssetPack::exists(std::string p_fileName)
+    {
+        std::string path;
+        std::shared_ptr<AssetPack> pack = findMount(p_fileName, path);
+        if(pack && pack->contains(path))
+            return true;
+
+        return std::ifstream(p_fileName.c_str()).good();
+    }
+}
@@ -19,73 +19,111 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "AudioSystem.hpp"
+#include "AssetPack.hpp"
+#include "MusicStream.hpp"
+#include "Trace.hpp"
+#include "VoicePool.hpp"
 
 #include <AL/al.h>
 #include <AL/alut.h>
+#include <algorithm>
 #include <iostream>
-#include <vorbis/vorbisfile.h>
+#include <stdexcept>
+#include <string>
 
 namespace TiltBall
 {
-    AudioSystem::AudioSystem()
+    AudioSystem::AudioSystem() :
+        m_ready(false),
+        m_alutInitialized(false),
+        m_music(0),
+        m_voices(0),
+        m_clickSoundBuffer(AL_NONE)
     {
-        // decode ogg music
-        OggVorbis_File vorbis;
-        ov_fopen("../resources/sound/music.ogg", &vorbis);
-
-        vorbis_info* info = ov_info(&vorbis, -1);
-        ALenum format = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
-        ALsizei rate = info->rate;
+        // opening the device and loading the sounds can take a while, the
+        // first frames don't need them
+        m_initialization = std::async(std::launch::async, &AudioSystem::initialize, this);
+    }
 
-        int bitstream;
-        char tmp[32768];
-        int bytesRead;
+    void AudioSystem::initialize()
+    {
+        TraceZone zone("AudioSystem::initialize");
 
-        do
+        try
+        {
+            load();
+            m_ready = true;
+        }
+        catch(std::exception& error)
         {
-            bytesRead = ov_read(&vorbis, tmp, 32768, 0, 2, 1, &bitstream);
-            m_vorbisBuffer.insert(m_vorbisBuffer.end(), tmp, tmp + bytesRead);
+            std::clog << "Audio disabled: " << error.what() << std::endl;
         }
-        while(bytesRead > 0);
+    }
 
-        ov_clear(&vorbis);
+    void AudioSystem::load()
+    {
+        if(!alutInit(0, 0))
+            throw std::runtime_error(std::string("Could not initialize audio: ") +
+                                     alutGetErrorString(alutGetError()));
+        m_alutInitialized = true;
+
+        // the music is decoded while it plays
+        m_music = new MusicStream("../resources/sound/music.ogg", 0.3f);
+
+        // import click sound into openal, straight from the mapping
+        std::shared_ptr<MappedFile> clickSound = AssetPack::openFile("../resources/sound/click.wav");
+        m_clickSoundBuffer = alutCreateBufferFromFileImage(clickSound->getData(),
+                                                           clickSound->getSize());
+        if(m_clickSoundBuffer == AL_NONE)
+            throw std::runtime_error(std::string("Could not load click sound: ") +
+                                     alutGetErrorString(alutGetError()));
+
+        m_voices = new VoicePool(AudioSystem::VOICE_COUNT);
+    }
 
-        std::clog << m_vorbisBuffer.size() << " bytes of music read" << std::endl;
+    bool AudioSystem::isReady() const
+    {
+        return m_ready;
+    }
 
-        alutInit(0, 0);
+    void AudioSystem::playClickSound()
+    {
+        if(!m_ready)
+            return;
 
-        // import music into openal and starting playing
-        alGenBuffers(1, &m_musicBuffer);
-        alGenSources(1, &m_musicSource);
+        m_voices->play(m_clickSoundBuffer, PRIORITY_INTERFACE, 1.0f, 1.0f);
+    }
 
-        alBufferData(m_musicBuffer,
-                     format,
-                     &m_vorbisBuffer[0],
-                     static_cast<ALsizei>(m_vorbisBuffer.size()),
-                     rate);
+    void AudioSystem::playImpactSound(float p_impulse)
+    {
+        if(!m_ready || p_impulse < AudioSystem::MIN_IMPACT_IMPULSE)
+            return;
 
-        alSourcei(m_musicSource, AL_BUFFER, m_musicBuffer);
-        alSourcef(m_musicSource, AL_GAIN, 0.3f);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(now - m_lastImpact < std::chrono::milliseconds(AudioSystem::MIN_IMPACT_INTERVAL_MILLISECONDS))
+            return;
 
-        alSourcePlay(m_musicSource);
+        if(m_voices->countPlaying(PRIORITY_IMPACT) >= AudioSystem::MAX_IMPACT_VOICES)
+            return;
 
-        // import click sound into openal
-        m_clickSoundBuffer = alutCreateBufferFromFile("../resources/sound/click.wav");
-        alGenSources(1, &m_clickSoundSource);
-        alSourcei(m_clickSoundSource, AL_BUFFER, m_clickSoundBuffer);
-    }
+        m_lastImpact = now;
 
-    void AudioSystem::playClickSound()
-    {
-        alSourcePlay(m_clickSoundSource);
+        // there is no impact sample, so the click stands in for it; harder
+        // hits are louder and a bit higher
+        float strength = std::min(p_impulse / AudioSystem::LOUDEST_IMPACT_IMPULSE, 1.0f);
+        m_voices->play(m_clickSoundBuffer, PRIORITY_IMPACT, strength, 0.7f + 0.3f * strength);
     }
 
     AudioSystem::~AudioSystem()
     {
-        alDeleteBuffers(1, &m_musicBuffer);
-        alDeleteSources(1, &m_musicSource);
-        alDeleteBuffers(1, &m_clickSoundBuffer);
-        alDeleteSources(1, &m_clickSoundSource);
-        alutExit();
+        // whatever got set up, even if not all of it, is torn down below
+        m_initialization.wait();
+
+        delete m_music;
+        delete m_voices;
+        if(m_clickSoundBuffer != AL_NONE)
+            alDeleteBuffers(1, &m_clickSoundBuffer);
+        if(m_alutInitialized)
+            alutExit();
     }
 }
@@ -0,0 +1,641 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AssetManifest.hpp"
+#include "AssetPack.hpp"
+#include "LevelParser.hpp"
+#include "LevelPhysics.hpp"
+#include "Simulation.hpp"
+#include "TiltScript.hpp"
+#include "WallCoordinates.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <dirent.h>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int DEFAULT_SYNTHETIC_WALLS = 1000000;
+
+    // shipped levels are small enough that a single load is lost in timer
+    // noise, so they are loaded this many times and the mean is reported
+    const int SMALL_LEVEL_REPETITIONS = 200;
+
+    const std::size_t SMALL_LEVEL_SIZE = 1 << 20;
+
+    // 100 seconds of simulated time at the default step rate
+    const int DEFAULT_COLLIDER_STEPS = 6000;
+
+    const int STARTUP_REPETITIONS = 20;
+
+    // script patterns Ogre 1.8 looks for when initializing a group
+    // (programs, materials, particles, compositors, overlays, fonts and
+    // overlay templates), each one another pass over every location
+    const int OGRE_SCRIPT_PATTERNS = 7;
+
+    struct ResourceLocation
+    {
+        std::string m_group;
+        std::string m_directory;
+        bool m_recursive;
+    };
+
+    // the locations Engine registered before the asset manifest, all of
+    // them initialized at startup
+    const ResourceLocation RECURSIVE_LOCATIONS[] =
+    {
+        {"General", "", true},
+        {"Imagesets", "cegui/imagesets", true},
+        {"Imagesets", "datafiles/imagesets", true},
+        {"Fonts", "datafiles/fonts", true},
+        {"Schemes", "cegui/schemes", true},
+        {"Schemes", "datafiles/schemes", true},
+        {"LookAndFeel", "datafiles/looknfeel", true},
+        {"Layouts", "cegui/layouts", true},
+        {"Layouts", "datafiles/layouts", true}
+    };
+
+    struct ScanCount
+    {
+        int m_directories;
+        int m_entries;
+    };
+
+    void usage(const char* p_program)
+    {
+        std::cerr << "Usage: " << p_program << " parse [--walls <count>] [level file...]"
+                  << std::endl;
+        std::cerr << "       " << p_program << " collider [--steps <count>] <level file...>"
+                  << std::endl;
+        std::cerr << "       " << p_program << " respawn <level file...>" << std::endl;
+        std::cerr << "       " << p_program << " startup <resource directory>" << std::endl;
+    }
+
+    std::string readFile(std::string p_fileName)
+    {
+        std::ifstream stream(p_fileName.c_str(), std::ios::binary);
+        if(!stream.good())
+            throw std::runtime_error("Could not open " + p_fileName);
+
+        std::ostringstream contents;
+        contents << stream.rdbuf();
+        return contents.str();
+    }
+
+    // a level the size of a big maze: a square grid of unit walls, written
+    // one wall per line the way a generator would
+    std::string buildSyntheticLevel(int p_wallCount)
+    {
+        int side = 1;
+        while(2 * side * side < p_wallCount)
+            side++;
+
+        std::ostringstream json;
+        json << "{\n"
+             << "    \"name\": \"synthetic\",\n"
+             << "    \"dimensions\": { \"x\": " << side + 1 << ", \"z\": " << side + 1 << " },\n"
+             << "    \"camera\": { \"x\": 0, \"y\": " << side << ", \"z\": 0.5 },\n"
+             << "    \"target\": { \"x\": 1, \"z\": 1.5 },\n"
+             << "    \"ball\": { \"x\": " << side / 2 << ", \"z\": " << side / 2 << " },\n"
+             << "    \"walls\": [\n";
+
+        int written = 0;
+        for(int z = 0; z < side && written < p_wallCount; z++)
+        {
+            for(int x = 0; x < side && written < p_wallCount; x++)
+            {
+                for(int direction = 0; direction < 2 && written < p_wallCount; direction++)
+                {
+                    if(written > 0)
+                        json << ",\n";
+
+                    json << "        { \"begin\": { \"x\": " << x << ", \"z\": " << z
+                         << " }, \"end\": { \"x\": " << x + 1 - direction
+                         << ", \"z\": " << z + direction << " } }";
+
+                    written++;
+                }
+            }
+        }
+
+        json << "\n    ]\n}\n";
+        return json.str();
+    }
+
+    // what LevelDescription did before it had its own parser
+    std::vector<TiltBall::WallCoordinates> loadWithPropertyTree(const std::string& p_json)
+    {
+        std::istringstream stream(p_json);
+        boost::property_tree::ptree pt;
+        read_json(stream, pt);
+
+        pt.get<std::string>("name");
+        pt.get<float>("dimensions.x");
+        pt.get<float>("dimensions.z");
+        pt.get<float>("camera.x");
+        pt.get<float>("camera.y");
+        pt.get<float>("camera.z");
+        pt.get<float>("target.x");
+        pt.get<float>("target.z");
+        pt.get<float>("ball.x");
+        pt.get<float>("ball.z");
+
+        std::vector<TiltBall::WallCoordinates> result;
+        const boost::property_tree::ptree& walls = pt.get_child("walls");
+        result.reserve(walls.size());
+        for(auto it = walls.begin(); it != walls.end(); it++)
+            result.push_back(TiltBall::WallCoordinates((*it).second.get<float>("begin.x"),
+                                                       (*it).second.get<float>("begin.z"),
+                                                       (*it).second.get<float>("end.x"),
+                                                       (*it).second.get<float>("end.z")));
+
+        return result;
+    }
+
+    std::vector<TiltBall::WallCoordinates> loadWithLevelParser(const std::string& p_json)
+    {
+        TiltBall::LevelParser parser(p_json.data(), p_json.data() + p_json.size(), "benchmark");
+        parser.parse();
+
+        std::vector<TiltBall::WallCoordinates> result;
+        result.swap(parser.getWalls());
+        return result;
+    }
+
+    bool sameWalls(const std::vector<TiltBall::WallCoordinates>& p_first,
+                   const std::vector<TiltBall::WallCoordinates>& p_second)
+    {
+        if(p_first.size() != p_second.size())
+            return false;
+
+        for(std::size_t i = 0; i < p_first.size(); i++)
+        {
+            if(p_first[i].getBeginX() != p_second[i].getBeginX() ||
+               p_first[i].getBeginZ() != p_second[i].getBeginZ() ||
+               p_first[i].getEndX() != p_second[i].getEndX() ||
+               p_first[i].getEndZ() != p_second[i].getEndZ())
+                return false;
+        }
+
+        return true;
+    }
+
+    // mean milliseconds per load
+    template<typename Loader>
+    double timeLoads(Loader p_loader,
+                     const std::string& p_json,
+                     int p_repetitions,
+                     std::vector<TiltBall::WallCoordinates>& p_walls)
+    {
+        Clock::time_point start = Clock::now();
+        for(int i = 0; i < p_repetitions; i++)
+            p_walls = p_loader(p_json);
+        Clock::time_point end = Clock::now();
+
+        return std::chrono::duration<double, std::milli>(end - start).count() / p_repetitions;
+    }
+
+    bool benchmarkParse(std::string p_label, const std::string& p_json)
+    {
+        int repetitions = p_json.size() < SMALL_LEVEL_SIZE ? SMALL_LEVEL_REPETITIONS : 1;
+
+        std::vector<TiltBall::WallCoordinates> treeWalls;
+        std::vector<TiltBall::WallCoordinates> parserWalls;
+
+        double treeTime = timeLoads(loadWithPropertyTree, p_json, repetitions, treeWalls);
+        double parserTime = timeLoads(loadWithLevelParser, p_json, repetitions, parserWalls);
+
+        bool same = sameWalls(treeWalls, parserWalls);
+
+        std::cout << std::left << std::setw(24) << p_label << std::right
+                  << std::setw(12) << p_json.size()
+                  << std::setw(10) << parserWalls.size()
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << treeTime
+                  << std::setw(14) << parserTime
+                  << std::setprecision(1)
+                  << std::setw(9) << treeTime / parserTime << 'x'
+                  << (same ? "" : "  MISMATCH") << std::endl;
+
+        return same;
+    }
+
+    int runParseBenchmark(int argc, char *argv[])
+    {
+        int syntheticWalls = DEFAULT_SYNTHETIC_WALLS;
+        std::vector<std::string> fileNames;
+
+        for(int i = 2; i < argc; i++)
+        {
+            if(std::strcmp(argv[i], "--walls") == 0 && i + 1 < argc)
+                syntheticWalls = atoi(argv[++i]);
+            else
+                fileNames.push_back(argv[i]);
+        }
+
+        std::cout << std::left << std::setw(24) << "level" << std::right
+                  << std::setw(12) << "bytes"
+                  << std::setw(10) << "walls"
+                  << std::setw(14) << "read_json ms"
+                  << std::setw(14) << "parser ms"
+                  << std::setw(10) << "speedup" << std::endl;
+
+        bool allSame = true;
+
+        for(auto it = fileNames.begin(); it < fileNames.end(); it++)
+        {
+            std::string label = *it;
+            std::size_t slash = label.find_last_of('/');
+            if(slash != std::string::npos)
+                label = label.substr(slash + 1);
+
+            allSame = benchmarkParse(label, readFile(*it)) && allSame;
+        }
+
+        if(syntheticWalls > 0)
+        {
+            std::ostringstream label;
+            label << "synthetic " << syntheticWalls;
+            allSame = benchmarkParse(label.str(), buildSyntheticLevel(syntheticWalls)) && allSame;
+        }
+
+        return allSame ? 0 : EXIT_FAILURE;
+    }
+
+    // tilts the level a few degrees back and forth around both axes, which
+    // keeps the ball rolling into walls without throwing it over them
+    TiltBall::TiltScript buildWobbleScript(float p_seconds)
+    {
+        TiltBall::TiltScript script;
+        while(script.getDuration() < p_seconds)
+        {
+            script.append(0.5, 10, 0);
+            script.append(0.5, 0, 10);
+            script.append(1, -10, 0);
+            script.append(1, 0, -10);
+            script.append(0.5, 10, 0);
+            script.append(0.5, 0, 10);
+        }
+        return script;
+    }
+
+    // mean microseconds per physics step
+    double timeSteps(std::string p_fileName,
+                     const TiltBall::TiltScript& p_script,
+                     TiltBall::LevelCollider::ColliderType p_colliderType,
+                     int p_steps)
+    {
+        TiltBall::Simulation simulation(p_fileName, p_script, p_colliderType);
+
+        Clock::time_point start = Clock::now();
+        for(int i = 0; i < p_steps; i++)
+            simulation.step();
+        Clock::time_point end = Clock::now();
+
+        return std::chrono::duration<double, std::micro>(end - start).count() / p_steps;
+    }
+
+    int runColliderBenchmark(int argc, char *argv[])
+    {
+        int steps = DEFAULT_COLLIDER_STEPS;
+        std::vector<std::string> fileNames;
+
+        for(int i = 2; i < argc; i++)
+        {
+            if(std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+                steps = atoi(argv[++i]);
+            else
+                fileNames.push_back(argv[i]);
+        }
+
+        if(fileNames.empty() || steps <= 0)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        // level loading is chatty
+        std::clog.rdbuf(0);
+
+        TiltBall::TiltScript script = buildWobbleScript(steps / 60.0f);
+
+        std::cout << std::left << std::setw(24) << "level" << std::right
+                  << std::setw(16) << "compound us" << std::setw(16) << "mesh us"
+                  << std::setw(10) << "speedup" << std::endl;
+
+        for(auto it = fileNames.begin(); it < fileNames.end(); it++)
+        {
+            std::string label = *it;
+            std::size_t slash = label.find_last_of('/');
+            if(slash != std::string::npos)
+                label = label.substr(slash + 1);
+
+            double compoundTime = timeSteps(*it, script,
+                                            TiltBall::LevelCollider::COLLIDER_COMPOUND, steps);
+            double meshTime = timeSteps(*it, script,
+                                        TiltBall::LevelCollider::COLLIDER_TRIANGLE_MESH, steps);
+
+            std::cout << std::left << std::setw(24) << label << std::right
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(16) << compoundTime
+                      << std::setw(16) << meshTime
+                      << std::setprecision(1)
+                      << std::setw(9) << compoundTime / meshTime << 'x' << std::endl;
+        }
+
+        return 0;
+    }
+
+    // compares loading a level again, as respawning used to, with
+    // resetting it; both after letting the ball roll for a while so there
+    // are contacts to throw away
+    int runRespawnBenchmark(int argc, char *argv[])
+    {
+        if(argc < 3)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        std::clog.rdbuf(0);
+
+        const int respawns = 100;
+        const int stepsBetweenRespawns = 60;
+
+        TiltBall::TiltScript script = buildWobbleScript(stepsBetweenRespawns / 60.0f);
+
+        std::cout << std::left << std::setw(24) << "level" << std::right
+                  << std::setw(16) << "reload us" << std::setw(16) << "reset us"
+                  << std::setw(10) << "speedup" << std::endl;
+
+        for(int i = 2; i < argc; i++)
+        {
+            std::string label = argv[i];
+            std::size_t slash = label.find_last_of('/');
+            if(slash != std::string::npos)
+                label = label.substr(slash + 1);
+
+            double reloadTime = 0;
+            double resetTime = 0;
+
+            for(int j = 0; j < respawns; j++)
+            {
+                TiltBall::Simulation* simulation =
+                    new TiltBall::Simulation(argv[i], script,
+                                             TiltBall::LevelCollider::COLLIDER_COMPOUND);
+                for(int k = 0; k < stepsBetweenRespawns; k++)
+                    simulation->step();
+
+                Clock::time_point start = Clock::now();
+                delete simulation;
+                simulation = new TiltBall::Simulation(argv[i], script,
+                                                      TiltBall::LevelCollider::COLLIDER_COMPOUND);
+                Clock::time_point end = Clock::now();
+                reloadTime += std::chrono::duration<double, std::micro>(end - start).count();
+
+                for(int k = 0; k < stepsBetweenRespawns; k++)
+                    simulation->step();
+
+                start = Clock::now();
+                simulation->reset();
+                end = Clock::now();
+                resetTime += std::chrono::duration<double, std::micro>(end - start).count();
+
+                delete simulation;
+            }
+
+            reloadTime /= respawns;
+            resetTime /= respawns;
+
+            std::cout << std::left << std::setw(24) << label << std::right
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(16) << reloadTime
+                      << std::setw(16) << resetTime
+                      << std::setprecision(0)
+                      << std::setw(9) << reloadTime / resetTime << 'x' << std::endl;
+        }
+
+        return 0;
+    }
+
+    // roughly what Ogre's FileSystem archive does with a location: list
+    // the directory, stat each entry to tell files from directories and
+    // descend into those when recursive
+    void scanDirectory(std::string p_directory, bool p_recursive, ScanCount& p_count)
+    {
+        DIR* directory = opendir(p_directory.c_str());
+        if(!directory)
+            return;
+
+        p_count.m_directories++;
+
+        while(dirent* entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+            if(name == "." || name == "..")
+                continue;
+
+            p_count.m_entries++;
+
+            std::string path = p_directory + "/" + name;
+            struct stat status;
+            if(stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode) && p_recursive)
+                scanDirectory(path, true, p_count);
+        }
+
+        closedir(directory);
+    }
+
+    // registering a location lists it once, initializing its group lists
+    // it again for each script pattern
+    double timeStartup(std::string p_resourceDirectory,
+                       const std::vector<ResourceLocation>& p_locations,
+                       const std::vector<std::string>& p_initializedGroups,
+                       ScanCount& p_count)
+    {
+        Clock::time_point start = Clock::now();
+
+        for(int i = 0; i < STARTUP_REPETITIONS; i++)
+        {
+            p_count.m_directories = 0;
+            p_count.m_entries = 0;
+
+            for(auto it = p_locations.begin(); it < p_locations.end(); it++)
+            {
+                std::string directory = p_resourceDirectory + "/" + it->m_directory;
+                scanDirectory(directory, it->m_recursive, p_count);
+
+                if(std::find(p_initializedGroups.begin(), p_initializedGroups.end(),
+                             it->m_group) == p_initializedGroups.end())
+                    continue;
+
+                for(int j = 0; j < OGRE_SCRIPT_PATTERNS; j++)
+                    scanDirectory(directory, it->m_recursive, p_count);
+            }
+        }
+
+        Clock::time_point end = Clock::now();
+        return std::chrono::duration<double, std::micro>(end - start).count() /
+            STARTUP_REPETITIONS;
+    }
+
+    // compares registering and initializing resources the way the game
+    // did before the asset manifest (recursive locations, every group
+    // initialized) with the manifest (its directories only, General
+    // initialized). with a warm cache this measures the file system calls
+    // rather than the disk; drop the page cache first for a cold start
+    int runStartupBenchmark(int argc, char *argv[])
+    {
+        if(argc != 3)
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        std::string resourceDirectory = argv[2];
+
+        std::vector<ResourceLocation> recursiveLocations(std::begin(RECURSIVE_LOCATIONS),
+                                                         std::end(RECURSIVE_LOCATIONS));
+        std::vector<std::string> allGroups;
+        for(auto it = recursiveLocations.begin(); it < recursiveLocations.end(); it++)
+        {
+            if(std::find(allGroups.begin(), allGroups.end(), it->m_group) == allGroups.end())
+                allGroups.push_back(it->m_group);
+        }
+
+        TiltBall::AssetManifest manifest;
+        manifest.load(resourceDirectory + "/assets.manifest");
+
+        std::vector<ResourceLocation> manifestLocations;
+        std::vector<std::string> groups = manifest.getGroups();
+        for(auto group = groups.begin(); group < groups.end(); group++)
+        {
+            std::vector<std::string> directories = manifest.getDirectories(*group);
+            for(auto it = directories.begin(); it < directories.end(); it++)
+            {
+                ResourceLocation location = {*group, *it, false};
+                manifestLocations.push_back(location);
+            }
+        }
+
+        ScanCount recursiveCount;
+        double recursiveTime = timeStartup(resourceDirectory, recursiveLocations, allGroups,
+                                           recursiveCount);
+
+        ScanCount manifestCount;
+        double manifestTime = timeStartup(resourceDirectory, manifestLocations,
+                                          std::vector<std::string>(1, "General"),
+                                          manifestCount);
+
+        std::cout << std::left << std::setw(24) << "registration" << std::right
+                  << std::setw(16) << "directories" << std::setw(16) << "entries"
+                  << std::setw(16) << "us" << std::endl;
+
+        std::cout << std::left << std::setw(24) << "recursive" << std::right
+                  << std::setw(16) << recursiveCount.m_directories
+                  << std::setw(16) << recursiveCount.m_entries
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(16) << recursiveTime << std::endl;
+
+        std::cout << std::left << std::setw(24) << "manifest" << std::right
+                  << std::setw(16) << manifestCount.m_directories
+                  << std::setw(16) << manifestCount.m_entries
+                  << std::setw(16) << manifestTime << std::endl;
+
+        // with the asset pack there is nothing to scan, mapping it and
+        // reading its index is all
+        std::string packFileName = resourceDirectory + "/assets.pack";
+        if(std::ifstream(packFileName.c_str()).good())
+        {
+            std::clog.rdbuf(0);
+
+            std::size_t packEntries = 0;
+            Clock::time_point start = Clock::now();
+            for(int i = 0; i < STARTUP_REPETITIONS; i++)
+            {
+                TiltBall::AssetPack pack(packFileName);
+                packEntries = 0;
+                std::vector<std::string> packGroups = pack.getGroups();
+                for(auto it = packGroups.begin(); it < packGroups.end(); it++)
+                    packEntries += pack.getPaths(*it).size();
+            }
+            Clock::time_point end = Clock::now();
+            double packTime = std::chrono::duration<double, std::micro>(end - start).count() /
+                STARTUP_REPETITIONS;
+
+            std::cout << std::left << std::setw(24) << "pack" << std::right
+                      << std::setw(16) << 0
+                      << std::setw(16) << packEntries
+                      << std::setw(16) << packTime << std::endl;
+        }
+
+        std::cout << std::setprecision(1) << recursiveTime / manifestTime
+                  << "x faster with the manifest, " << manifest.getAssets().size()
+                  << " assets in it" << std::endl;
+
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 2)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        if(std::strcmp(argv[1], "parse") == 0)
+            return runParseBenchmark(argc, argv);
+
+        if(std::strcmp(argv[1], "collider") == 0)
+            return runColliderBenchmark(argc, argv);
+
+        if(std::strcmp(argv[1], "respawn") == 0)
+            return runRespawnBenchmark(argc, argv);
+
+        if(std::strcmp(argv[1], "startup") == 0)
+            return runStartupBenchmark(argc, argv);
+
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    catch(std::exception& error)
+    {
+        std::cerr << "ERROR: " << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,69 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BoxCoordinates.hpp"
+
+namespace TiltBall
+{
+    BoxCoordinates::BoxCoordinates(float p_x1,
+                                   float p_y1,
+                                   float p_z1,
+                                   float p_x2,
+                                   float p_y2,
+                                   float p_z2) :
+        m_x1(p_x1),
+        m_y1(p_y1),
+        m_z1(p_z1),
+        m_x2(p_x2),
+        m_y2(p_y2),
+        m_z2(p_z2)
+    {
+    }
+
+    float BoxCoordinates::getX1() const
+    {
+        return m_x1;
+    }
+
+    float BoxCoordinates::getY1() const
+    {
+        return m_y1;
+    }
+
+    float BoxCoordinates::getZ1() const
+    {
+        return m_z1;
+    }
+
+    float BoxCoordinates::getX2() const
+    {
+        return m_x2;
+    }
+
+    float BoxCoordinates::getY2() const
+    {
+        return m_y2;
+    }
+
+    float BoxCoordinates::getZ2() const
+    {
+        return m_z2;
+    }
+}
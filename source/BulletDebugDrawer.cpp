@@ -21,8 +21,6 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 #include "BulletDebugDrawer.hpp"
 #include "Engine.hpp"
 
-#include <sstream>
-
 namespace TiltBall
 {
     BulletDebugDrawer::BulletDebugDrawer(Engine* p_engine) :
@@ -30,56 +28,115 @@ namespace TiltBall
         m_material(
             dynamic_cast<Ogre::Material*>(
                 Ogre::MaterialManager::getSingletonPtr()->create("Debug/BulletDebugDrawMaterial",
-                                                                 "Debugging").get()))
+                                                                 "Debugging").get())),
+        m_node(0),
+        m_lineObject(0),
+        m_shownVertexCount(0)
     {
+        // the lines come in their own colours
         m_material->setReceiveShadows(false);
-        m_material->getTechnique(0)->setLightingEnabled(true);
-        m_material->getTechnique(0)->getPass(0)->setDiffuse(0,0,1,0);
-        m_material->getTechnique(0)->getPass(0)->setAmbient(0,0,1);
-        m_material->getTechnique(0)->getPass(0)->setSelfIllumination(0,0,1);
+        m_material->getTechnique(0)->setLightingEnabled(false);
+    }
+
+    BulletDebugDrawer::~BulletDebugDrawer()
+    {
+        resetScene();
     }
 
     void BulletDebugDrawer::drawLine(const btVector3& p_from,
                                      const btVector3& p_to,
                                      const btVector3& p_color)
+    {
+        addVertex(p_from, p_color);
+        addVertex(p_to, p_color);
+    }
+
+    void BulletDebugDrawer::addVertex(const btVector3& p_position, const btVector3& p_colour)
+    {
+        LineVertex vertex;
+        vertex.m_position[0] = p_position.getX();
+        vertex.m_position[1] = p_position.getY();
+        vertex.m_position[2] = p_position.getZ();
+        vertex.m_colour[0] = p_colour.getX();
+        vertex.m_colour[1] = p_colour.getY();
+        vertex.m_colour[2] = p_colour.getZ();
+
+        m_vertices.push_back(vertex);
+    }
+
+    void BulletDebugDrawer::clear()
+    {
+        m_vertices.clear();
+    }
+
+    void BulletDebugDrawer::resetScene()
+    {
+        if(!m_lineObject)
+            return;
+
+        Ogre::SceneManager* sceneManager = m_engine->getOgreRoot()->
+            getSceneManager("main_scene_manager");
+
+        m_node->detachObject(m_lineObject);
+        sceneManager->destroyManualObject(m_lineObject);
+        sceneManager->getRootSceneNode()->removeAndDestroyChild(m_node->getName());
+
+        m_lineObject = 0;
+        m_node = 0;
+        m_shownVertexCount = 0;
+    }
+
+    void BulletDebugDrawer::createSceneObjects()
     {
         Ogre::SceneManager* sceneManager = m_engine->getOgreRoot()->
             getSceneManager("main_scene_manager");
 
-        std::ostringstream lineNodeName;
-        lineNodeName << "lineNode" << m_lines.size();
-        std::ostringstream lineObjectName;
-        lineObjectName << "lineObject" << m_lines.size();
-        Ogre::SceneNode* manualObjectNode = sceneManager->getRootSceneNode()->
-            createChildSceneNode(lineNodeName.str());
-        Ogre::ManualObject* manualObject = sceneManager->createManualObject(lineObjectName.str());
-
-        manualObject->begin("Debug/BulletDebugMaterial", Ogre::RenderOperation::OT_LINE_LIST);
-        manualObject->position(p_from.getX(), p_from.getY(), p_from.getZ());
-        manualObject->position(p_to.getX(), p_to.getY(), p_to.getZ());
-        manualObject->end();
-
-        manualObjectNode->attachObject(manualObject);
-        m_lines.push_back(manualObjectNode);
+        m_lineObject = sceneManager->createManualObject("debug_lines");
+        m_lineObject->setDynamic(true);
+        m_lineObject->setCastShadows(false);
+
+        m_node = sceneManager->getRootSceneNode()->createChildSceneNode("debug_lines");
+        m_node->attachObject(m_lineObject);
     }
 
-    void BulletDebugDrawer::clear()
+    void BulletDebugDrawer::update()
     {
-        Ogre::SceneManager* sceneManager =
-            m_engine->getOgreRoot()->getSceneManager("main_scene_manager");
+        // nothing drawn now and nothing shown from before
+        if(m_vertices.empty() && m_shownVertexCount == 0)
+            return;
+
+        if(!m_lineObject)
+            createSceneObjects();
 
-        for(auto it = m_lines.begin(); it < m_lines.end(); it++)
+        // ManualObject drops a section that starts out empty, but keeps
+        // one that is emptied by an update
+        if(m_lineObject->getNumSections() == 0)
         {
-            Ogre::ManualObject* manualObject =
-                dynamic_cast<Ogre::ManualObject*>((*it)->getAttachedObject(0));
+            if(m_vertices.empty())
+                return;
 
-            (*it)->detachObject(manualObject);
-            sceneManager->destroyManualObject(manualObject);
+            m_lineObject->estimateVertexCount(m_vertices.size());
+            m_lineObject->begin("Debug/BulletDebugDrawMaterial",
+                                Ogre::RenderOperation::OT_LINE_LIST,
+                                "Debugging");
+        }
+        else
+        {
+            // grows the hardware buffer once instead of doubling it along
+            // the way
+            m_lineObject->estimateVertexCount(m_vertices.size());
+            m_lineObject->beginUpdate(0);
+        }
 
-            sceneManager->getRootSceneNode()->removeAndDestroyChild((*it)->getName());
+        for(auto it = m_vertices.begin(); it < m_vertices.end(); it++)
+        {
+            m_lineObject->position(it->m_position[0], it->m_position[1], it->m_position[2]);
+            m_lineObject->colour(it->m_colour[0], it->m_colour[1], it->m_colour[2]);
         }
 
-        m_lines.clear();
+        m_lineObject->end();
+
+        m_shownVertexCount = m_vertices.size();
     }
 
     void BulletDebugDrawer::drawContactPoint(const btVector3& p_pointOnB,
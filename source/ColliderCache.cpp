@@ -0,0 +1,90 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ColliderCache.hpp"
+#include "Trace.hpp"
+
+#include <cerrno>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace TiltBall
+{
+    ColliderCache::ColliderCache(std::string p_directory) :
+        m_directory(p_directory)
+    {
+        // without the directory the BVHs are simply built every time
+        if(mkdir(m_directory.c_str(), 0755) < 0 && errno != EEXIST)
+            std::clog << "Could not create collider cache directory " << m_directory << std::endl;
+    }
+
+    std::shared_ptr<LevelCollider> ColliderCache::getCollider(
+        const LevelDescription& p_description,
+        LevelCollider::ColliderType p_colliderType)
+    {
+        TraceZone zone("ColliderCache::getCollider");
+
+        std::pair<uint64_t, int> key(p_description.getFileHash(), p_colliderType);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto found = m_colliders.find(key);
+            if(found != m_colliders.end())
+            {
+                std::clog << "Reusing level collision shapes" << std::endl;
+                return found->second;
+            }
+        }
+
+        // compound shapes have nothing worth keeping on disk, Bullet builds
+        // their trees incrementally as children are added
+        std::string bvhFileName;
+        if(p_colliderType == LevelCollider::COLLIDER_TRIANGLE_MESH)
+            bvhFileName = buildBvhFileName(p_description.getFileHash());
+
+        std::shared_ptr<LevelCollider> collider =
+            std::make_shared<LevelCollider>(p_description, p_colliderType, bvhFileName);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // keep whichever got here first if another thread built it as well
+        auto inserted = m_colliders.insert(std::make_pair(key, collider));
+
+        return inserted.first->second;
+    }
+
+    void ColliderCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_colliders.clear();
+    }
+
+    std::string ColliderCache::buildBvhFileName(uint64_t p_fileHash) const
+    {
+        std::ostringstream stream;
+        stream << m_directory << '/' << std::hex << std::setw(16) << std::setfill('0')
+               << p_fileHash << ".bvh";
+        return stream.str();
+    }
+}
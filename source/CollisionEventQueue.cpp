@@ -18,31 +18,42 @@ You should have received a copy of the GNU General Public License
 along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include "WorldObject.hpp"
+#include "CollisionEventQueue.hpp"
 
 namespace TiltBall
 {
-    WorldObject::WorldObject(Ogre::MovableObject* p_movableObject,
-                             btCollisionShape* p_collisionShape,
-                             btTransform p_transform)
+    CollisionEventQueue::CollisionEventQueue() :
+        m_next(0)
     {
-        m_movableObject = p_movableObject;
-        m_collisionShape = p_collisionShape;
-        m_transform = p_transform;
+        m_events.reserve(CollisionEventQueue::INITIAL_CAPACITY);
     }
 
-    Ogre::MovableObject* WorldObject::getMovableObject()
+    void CollisionEventQueue::push(CollisionEvent::Type p_type, float p_impulse)
     {
-        return m_movableObject;
+        CollisionEvent event;
+        event.m_type = p_type;
+        event.m_impulse = p_impulse;
+
+        m_events.push_back(event);
     }
 
-    btCollisionShape* WorldObject::getCollisionShape()
+    bool CollisionEventQueue::pop(CollisionEvent& p_event)
     {
-        return m_collisionShape;
+        if(m_next >= m_events.size())
+        {
+            clear();
+            return false;
+        }
+
+        p_event = m_events[m_next];
+        m_next++;
+
+        return true;
     }
 
-    btTransform WorldObject::getTransform()
+    void CollisionEventQueue::clear()
     {
-        return m_transform;
+        m_events.clear();
+        m_next = 0;
     }
 }
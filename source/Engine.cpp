@@ -19,80 +19,143 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "Engine.hpp"
+#include "AssetManifest.hpp"
+#include "AssetPack.hpp"
 #include "AudioSystem.hpp"
 #include "BulletDebugDrawer.hpp"
-#include "RunningState.hpp"
+#include "MenuState.hpp"
+#include "PackArchive.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <map>
+#include <thread>
 
 namespace TiltBall
 {
     Engine::Engine() :
+        m_startTime(std::chrono::steady_clock::now()),
         m_ogreRoot(initOgreRoot()),
 
-        m_collisionConfiguration(new btDefaultCollisionConfiguration()),
-        m_dispatcher(new btCollisionDispatcher(m_collisionConfiguration)),
-        m_broadphase(new btDbvtBroadphase()),
-        m_solver(new btSequentialImpulseConstraintSolver()),
-        m_dynamicsWorld(new btDiscreteDynamicsWorld(m_dispatcher,
-                                                    m_broadphase,
-                                                    m_solver,
-                                                    m_collisionConfiguration)),
+        m_physicsWorld(new PhysicsWorld()),
+        m_colliderCache(new ColliderCache("collider_cache")),
 
         m_inputSystem(new InputSystem(getOgreRoot())),
         m_audioSystem(new AudioSystem()),
         m_ceguiRenderer(&CEGUI::OgreRenderer::bootstrapSystem(*(getOgreRoot()->
                                                                 getRenderTarget("main_window")))),
-        m_timeSinceLastFrame(0),
+        m_profiler(new FrameProfiler()),
+        m_profilerOverlay(0),
+        m_frozenFrame(new FrozenFrame()),
+        m_packArchiveFactory(0),
+        m_guiRenderQueueListener(new GuiRenderQueueListener(m_profiler)),
+        m_inputInterval(rateToInterval(Engine::DEFAULT_INPUT_RATE)),
+        m_simulationInterval(rateToInterval(Engine::DEFAULT_SIMULATION_RATE)),
+        m_renderInterval(rateToInterval(Engine::DEFAULT_RENDER_RATE)),
+        m_menuState(0),
+        m_requestRedraw(true),
         m_requestPop(false),
-        m_requestQuit(false)
+        m_requestQuit(false),
+        m_firstFrameRendered(false),
+        m_hiddenVisibilityMask(0),
+        m_sceneHidden(false)
     {
+        registerResources();
+
+        CEGUI::Imageset::setDefaultResourceGroup("Imagesets");
+        CEGUI::Font::setDefaultResourceGroup("Fonts");
+        CEGUI::Scheme::setDefaultResourceGroup("Schemes");
+        CEGUI::WidgetLookManager::setDefaultResourceGroup("LookAndFeel");
+        CEGUI::WindowManager::setDefaultResourceGroup("Layouts");
+
+        // CEGUI opens its files straight from the group indexes, so its
+        // groups never need initializing; the Ogre scripts in General are
+        // parsed by whoever needs them first, see loadResourceGroup()
+        CEGUI::SchemeManager::getSingleton().create("TaharezLook.scheme");
+        CEGUI::System::getSingleton().setDefaultMouseCursor("TaharezLook", "MouseArrow");
+
+        Ogre::ResourceGroupManager::getSingleton().createResourceGroup("Debugging");
+
+        m_debugDrawer = new BulletDebugDrawer(this);
+        getDynamicsWorld()->setDebugDrawer(m_debugDrawer);
+
+        // the GUI is drawn from the render queue so its time can be told
+        // apart from the rest of the frame
+        m_ceguiRenderer->setFrameControlExecutionEnabled(false);
+        getOgreRoot()->getSceneManager("main_scene_manager")->
+            addRenderQueueListener(m_guiRenderQueueListener);
+
+        m_physicsWorld->setProfiler(m_profiler);
+
+        m_states.reserve(Engine::STATE_CAPACITY);
+
+        std::clog << "Engine ready after "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - m_startTime).count()
+                  << " ms" << std::endl;
+    }
+
+    void Engine::registerResources()
+    {
+        TraceZone zone("Engine::registerResources");
+
         std::clog << "Setting up resource manager..." << std::endl;
         Ogre::ResourceGroupManager* resourceGroupManager =
             Ogre::ResourceGroupManager::getSingletonPtr();
 
-        resourceGroupManager->addResourceLocation("../resources", "FileSystem", "General", true);
-
-        resourceGroupManager->addResourceLocation("../resources/cegui/imagesets",
-                                                  "FileSystem", "Imagesets", true);
-        resourceGroupManager->addResourceLocation("../resources/datafiles/imagesets",
-                                                  "FileSystem", "Imagesets", true);
-
-        resourceGroupManager->addResourceLocation("../resources/datafiles/fonts",
-                                                  "FileSystem", "Fonts", true);
+        // everything comes from the asset pack when the build made one
+        std::shared_ptr<AssetPack> pack = AssetPack::getMounted("../resources");
+        if(pack)
+        {
+            m_packArchiveFactory = new PackArchiveFactory(pack);
+            Ogre::ArchiveManager::getSingleton().addArchiveFactory(m_packArchiveFactory);
 
-        resourceGroupManager->addResourceLocation("../resources/cegui/schemes",
-                                                  "FileSystem", "Schemes", true);
-        resourceGroupManager->addResourceLocation("../resources/datafiles/schemes",
-                                                  "FileSystem", "Schemes", true);
+            std::vector<std::string> groups = pack->getGroups();
+            for(auto group = groups.begin(); group < groups.end(); group++)
+            {
+                resourceGroupManager->addResourceLocation(*group + "@../resources/assets.pack",
+                                                          PackArchiveFactory::TYPE, *group);
+            }
 
-        resourceGroupManager->addResourceLocation("../resources/datafiles/looknfeel",
-                                                  "FileSystem", "LookAndFeel", true);
+            std::clog << "Registered " << groups.size() << " resource groups from the asset pack"
+                      << std::endl;
+            return;
+        }
 
-        resourceGroupManager->addResourceLocation("../resources/cegui/layouts",
-                                                  "FileSystem", "Layouts", true);
-        resourceGroupManager->addResourceLocation("../resources/datafiles/layouts",
-                                                  "FileSystem", "Layouts", true);
+        // otherwise only the directories holding assets the game uses,
+        // each indexed on its own rather than walking the whole resource
+        // tree
+        AssetManifest manifest;
+        manifest.load("../resources/assets.manifest");
 
-        CEGUI::Imageset::setDefaultResourceGroup("Imagesets");
-        CEGUI::Font::setDefaultResourceGroup("Fonts");
-        CEGUI::Scheme::setDefaultResourceGroup("Schemes");
-        CEGUI::WidgetLookManager::setDefaultResourceGroup("LookAndFeel");
-        CEGUI::WindowManager::setDefaultResourceGroup("Layouts");
+        std::vector<std::string> groups = manifest.getGroups();
+        for(auto group = groups.begin(); group < groups.end(); group++)
+        {
+            std::vector<std::string> directories = manifest.getDirectories(*group);
+            for(auto it = directories.begin(); it < directories.end(); it++)
+            {
+                resourceGroupManager->addResourceLocation("../resources/" + *it,
+                                                          "FileSystem", *group, false);
+            }
+        }
 
-        resourceGroupManager->initialiseAllResourceGroups();
+        std::clog << "Registered " << manifest.getAssets().size() << " assets in "
+                  << groups.size() << " resource groups" << std::endl;
+    }
 
-        CEGUI::SchemeManager::getSingleton().create("TaharezLook.scheme");
-        CEGUI::System::getSingleton().setDefaultMouseCursor("TaharezLook", "MouseArrow");
+    void Engine::loadResourceGroup(std::string p_group)
+    {
+        Ogre::ResourceGroupManager* resourceGroupManager =
+            Ogre::ResourceGroupManager::getSingletonPtr();
 
-        m_dynamicsWorld->setGravity(btVector3(0, -250, 0));
-        m_dynamicsWorld->setInternalTickCallback(bulletTickCallback);
-        m_dynamicsWorld->setWorldUserInfo(this);
+        if(resourceGroupManager->isResourceGroupInitialised(p_group))
+            return;
 
-        resourceGroupManager->createResourceGroup("Debugging");
+        TraceZone zone("Engine::loadResourceGroup");
 
-        m_debugDrawer = new BulletDebugDrawer(this);
-        m_dynamicsWorld->setDebugDrawer(m_debugDrawer);
+        std::clog << "Initializing resource group " << p_group << "..." << std::endl;
+        resourceGroupManager->initialiseResourceGroup(p_group);
     }
 
     Ogre::Root* Engine::initOgreRoot()
@@ -125,11 +188,13 @@ namespace TiltBall
 
         std::clog << "Initializing ogreRoot..." << std::endl;
         ogreRoot->initialise(false);
-        ogreRoot->addFrameListener(this);
 
         std::clog << "Creating render window..." << std::endl;
         Ogre::NameValuePairList params;
         params.insert(std::pair<Ogre::String, Ogre::String>("title", "TiltBall"));
+        params.insert(std::pair<Ogre::String, Ogre::String>("vsync",
+                                                            Engine::DEFAULT_VSYNC ?
+                                                            "true" : "false"));
         ogreRoot->createRenderWindow("main_window", 1024, 768, false, &params);
 
         std::clog << "Creating scene manager..." << std::endl;
@@ -142,18 +207,28 @@ namespace TiltBall
     {
         std::clog << "Engine destructor" << std::endl;
 
+        getOgreRoot()->getSceneManager("main_scene_manager")->
+            removeRenderQueueListener(m_guiRenderQueueListener);
+        delete m_guiRenderQueueListener;
+
+        delete m_menuState;
+
         CEGUI::OgreRenderer::destroySystem();
         delete m_audioSystem;
         delete m_inputSystem;
 
-        delete m_dynamicsWorld;
-        delete m_solver;
-        delete m_broadphase;
-        delete m_dispatcher;
-        delete m_collisionConfiguration;
+        delete m_colliderCache;
+        delete m_physicsWorld;
         delete m_debugDrawer;
 
+        delete m_profilerOverlay;
+        delete m_profiler;
+        delete m_frozenFrame;
+
         delete m_ogreRoot;
+
+        // Ogre unloads the pack's archives as it shuts down
+        delete m_packArchiveFactory;
     }
 
     void Engine::pushState(GameState* p_state)
@@ -161,12 +236,23 @@ namespace TiltBall
         m_inputSystem->getKeyboard()->setEventCallback(0);
         m_inputSystem->getMouse()->setEventCallback(0);
 
+        if(!m_states.empty())
+            pauseState(m_states.back());
+
         m_states.push_back(p_state);
 
         m_inputSystem->getKeyboard()->setEventCallback(m_states.back());
         m_inputSystem->getMouse()->setEventCallback(m_states.back());
     }
 
+    MenuState* Engine::getMenuState()
+    {
+        if(!m_menuState)
+            m_menuState = new MenuState(this);
+
+        return m_menuState;
+    }
+
     void Engine::popState()
     {
         m_inputSystem->getKeyboard()->setEventCallback(0);
@@ -175,14 +261,88 @@ namespace TiltBall
         GameState* oldState = m_states.back();
         m_states.pop_back();
 
-        m_inputSystem->getKeyboard()->setEventCallback(m_states.back());
-        m_inputSystem->getMouse()->setEventCallback(m_states.back());
+        if(!m_states.empty())
+        {
+            m_inputSystem->getKeyboard()->setEventCallback(m_states.back());
+            m_inputSystem->getMouse()->setEventCallback(m_states.back());
+        }
 
-        delete oldState;
+        if(oldState != m_menuState)
+            delete oldState;
+
+        if(!m_states.empty())
+            resumeState(m_states.back());
 
         m_requestPop = false;
     }
 
+    void Engine::pauseState(GameState* p_state)
+    {
+        p_state->pause();
+
+        Ogre::Viewport* viewport = getMainViewport();
+
+        switch(p_state->getPausedRendering())
+        {
+        case GameState::PAUSED_RENDER_FROZEN:
+            if(viewport)
+                m_frozenFrame->capture(viewport);
+            break;
+
+        case GameState::PAUSED_RENDER_NONE:
+            if(viewport && !m_sceneHidden)
+            {
+                m_hiddenVisibilityMask = viewport->getVisibilityMask();
+                viewport->setVisibilityMask(0);
+                m_sceneHidden = true;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        m_requestRedraw = true;
+    }
+
+    void Engine::resumeState(GameState* p_state)
+    {
+        switch(p_state->getPausedRendering())
+        {
+        case GameState::PAUSED_RENDER_FROZEN:
+            m_frozenFrame->release();
+            break;
+
+        case GameState::PAUSED_RENDER_NONE:
+            if(m_sceneHidden)
+            {
+                Ogre::Viewport* viewport = getMainViewport();
+                if(viewport)
+                    viewport->setVisibilityMask(m_hiddenVisibilityMask);
+                m_sceneHidden = false;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        p_state->resume();
+
+        m_requestRedraw = true;
+    }
+
+    Ogre::Viewport* Engine::getMainViewport()
+    {
+        Ogre::RenderTarget* window = getOgreRoot()->getRenderTarget("main_window");
+        return window->getNumViewports() > 0 ? window->getViewport(0) : 0;
+    }
+
+    void Engine::requestRedraw()
+    {
+        m_requestRedraw = true;
+    }
+
     void Engine::requestPop()
     {
         m_requestPop = true;
@@ -197,8 +357,17 @@ namespace TiltBall
     {
         std::clog << "Entering main loop..." << std::endl;
 
-        bool keepRendering = true;
-        while(keepRendering)
+        Ogre::RenderWindow* window =
+            dynamic_cast<Ogre::RenderWindow*>(getOgreRoot()->getRenderTarget("main_window"));
+
+        Ogre::Timer timer;
+        double lastInputTime = 0;
+        double lastSimulationTime = 0;
+        double nextInputTime = 0;
+        double nextSimulationTime = 0;
+        double nextRenderTime = 0;
+
+        while(true)
         {
             if(m_requestPop)
                 popState();
@@ -208,86 +377,176 @@ namespace TiltBall
                 break;
 
             Ogre::WindowEventUtilities::messagePump();
-            keepRendering = getOgreRoot()->renderOneFrame();
+            if(window->isClosed())
+                break;
+
+            double now = timer.getMicroseconds() / 1000000.0;
+
+            if(now >= nextInputTime)
+            {
+                Ogre::FrameEvent event;
+                event.timeSinceLastEvent = now - lastInputTime;
+                event.timeSinceLastFrame = now - lastInputTime;
+
+                bool keepRunning;
+                {
+                    TraceZone zone("Engine::update");
+                    keepRunning = m_states.back()->update(event);
+                }
+                if(!keepRunning)
+                    break;
+
+                lastInputTime = now;
+                nextInputTime = scheduleNext(nextInputTime, m_inputInterval, now);
+            }
+
+            if(now >= nextSimulationTime)
+            {
+                TraceZone zone("Engine::simulate");
+                m_states.back()->simulate(now - lastSimulationTime);
+
+                lastSimulationTime = now;
+                nextSimulationTime = scheduleNext(nextSimulationTime, m_simulationInterval, now);
+            }
+
+            // states that only change on input (the menu) are drawn when
+            // they ask for it, everything else whenever a frame is due
+            bool renderWanted = m_requestRedraw || m_states.back()->needsContinuousRendering();
+
+            if(renderWanted && now >= nextRenderTime)
+            {
+                m_requestRedraw = false;
+
+                bool keepRunning;
+                {
+                    TraceZone zone("Engine::render");
+                    FrameProfiler::Scope scope(m_profiler, FrameProfiler::SECTION_RENDER);
+                    keepRunning = getOgreRoot()->renderOneFrame();
+                }
+                if(!keepRunning)
+                    break;
+
+                // a frame ends with each one rendered
+                m_profiler->endFrame();
+                if(m_profilerOverlay)
+                    m_profilerOverlay->update();
+
+                if(!m_firstFrameRendered)
+                {
+                    std::clog << "First frame rendered after "
+                              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  std::chrono::steady_clock::now() - m_startTime).count()
+                              << " ms" << std::endl;
+                    m_firstFrameRendered = true;
+                }
+
+                nextRenderTime = scheduleNext(nextRenderTime, m_renderInterval, now);
+            }
+
+            // nothing to do until the next input update or frame is due;
+            // with an unlimited render rate we never sleep and leave the
+            // waiting to vsync. without a frame to draw, only input wakes
+            // us up
+            double wakeTime = nextInputTime;
+            if(m_requestRedraw || m_states.back()->needsContinuousRendering())
+                wakeTime = std::min(wakeTime, nextRenderTime);
+            if(m_simulationInterval > 0)
+                wakeTime = std::min(wakeTime, nextSimulationTime);
+
+            now = timer.getMicroseconds() / 1000000.0;
+            if(wakeTime > now)
+                std::this_thread::sleep_for(
+                    std::chrono::microseconds(static_cast<long>((wakeTime - now) * 1000000)));
         }
     }
 
-    Ogre::Root* Engine::getOgreRoot()
+    double Engine::scheduleNext(double p_due, double p_interval, double p_now)
     {
-        return m_ogreRoot;
+        // keep a steady rate, but don't try to make up for missed updates
+        double next = p_due + p_interval;
+        return next < p_now ? p_now + p_interval : next;
     }
 
-    BulletDebugDrawer* Engine::getDebugDrawer()
+    float Engine::rateToInterval(float p_rate)
     {
-        return m_debugDrawer;
+        return p_rate > 0 ? 1 / p_rate : 0;
     }
 
-    btDiscreteDynamicsWorld* Engine::getDynamicsWorld()
+    void Engine::setInputRate(float p_updatesPerSecond)
     {
-        return m_dynamicsWorld;
+        m_inputInterval = rateToInterval(p_updatesPerSecond);
     }
 
-    bool Engine::frameStarted(const Ogre::FrameEvent& p_event)
+    void Engine::setSimulationRate(float p_updatesPerSecond)
     {
-        m_timeSinceLastFrame += p_event.timeSinceLastFrame;
-        if (m_timeSinceLastFrame < INPUT_UPDATE_INTERVAL)
-            return true;
-
-        bool ret = m_states.back()->update(p_event);
+        m_simulationInterval = rateToInterval(p_updatesPerSecond);
+    }
 
-        m_timeSinceLastFrame = 0;
+    void Engine::setRenderRate(float p_framesPerSecond)
+    {
+        m_renderInterval = rateToInterval(p_framesPerSecond);
+    }
 
-        return ret;
+    void Engine::setVSyncEnabled(bool p_enabled)
+    {
+        dynamic_cast<Ogre::RenderWindow*>(getOgreRoot()->getRenderTarget("main_window"))->
+            setVSyncEnabled(p_enabled);
     }
 
-    InputSystem* Engine::getInputSystem()
+    Ogre::Root* Engine::getOgreRoot()
     {
-        return m_inputSystem;
+        return m_ogreRoot;
     }
 
-    AudioSystem* Engine::getAudioSystem()
+    BulletDebugDrawer* Engine::getDebugDrawer()
     {
-        return m_audioSystem;
+        return m_debugDrawer;
     }
 
-    float Engine::getTimeSinceLastFrame()
+    FrameProfiler* Engine::getProfiler()
     {
-        return m_timeSinceLastFrame;
+        return m_profiler;
     }
 
-    GameState* Engine::getCurrentState()
+    ProfilerOverlay* Engine::getProfilerOverlay()
     {
-        return m_states.back();
+        // the overlay script is only parsed with the rest of General
+        if(!m_profilerOverlay)
+        {
+            loadResourceGroup("General");
+            m_profilerOverlay = new ProfilerOverlay(m_profiler);
+        }
+
+        return m_profilerOverlay;
     }
 
-    void bulletTickCallback(btDynamicsWorld* p_world, btScalar p_timeStep)
+    PhysicsWorld* Engine::getPhysicsWorld()
     {
-        // if the physics simulation is running, we must be in
-        // RunningState, grab the pointer so we can use it
-        // below to play the clicking sound
-        Engine* engine = static_cast<Engine*>(p_world->getWorldUserInfo());
-        RunningState* state = dynamic_cast<RunningState*>(engine->getCurrentState());
+        return m_physicsWorld;
+    }
 
-        int numManifolds = p_world->getDispatcher()->getNumManifolds();
+    btDiscreteDynamicsWorld* Engine::getDynamicsWorld()
+    {
+        return m_physicsWorld->getDynamicsWorld();
+    }
 
-        for(auto i = 0; i < numManifolds; i++)
-        {
-            btPersistentManifold* manifold =
-                p_world->getDispatcher()->getManifoldByIndexInternal(i);
+    ColliderCache* Engine::getColliderCache()
+    {
+        return m_colliderCache;
+    }
 
-            const btCollisionObject* object1 =
-                static_cast<const btCollisionObject*>(manifold->getBody0());
-            const btCollisionObject* object2 =
-                static_cast<const btCollisionObject*>(manifold->getBody1());
+    InputSystem* Engine::getInputSystem()
+    {
+        return m_inputSystem;
+    }
 
-            Ogre::SceneNode* object1Node = static_cast<Ogre::SceneNode*>(object1->getUserPointer());
-            Ogre::SceneNode* object2Node = static_cast<Ogre::SceneNode*>(object2->getUserPointer());
+    AudioSystem* Engine::getAudioSystem()
+    {
+        return m_audioSystem;
+    }
 
-            if(object1Node->getName() == "target" || object2Node->getName() == "target")
-            {
-                std::clog << "Level complete!" << std::endl;
-                state->loadNextLevel();
-            }
-        }
+    GameState* Engine::getCurrentState()
+    {
+        return m_states.back();
     }
 }
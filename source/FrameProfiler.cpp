@@ -0,0 +1,226 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "FrameProfiler.hpp"
+
+#include <algorithm>
+
+namespace TiltBall
+{
+    FrameProfiler::Scope::Scope(FrameProfiler* p_profiler, Section p_section) :
+        m_profiler(p_profiler),
+        m_section(p_section)
+    {
+        if(m_profiler)
+            m_profiler->begin(m_section);
+    }
+
+    FrameProfiler::Scope::~Scope()
+    {
+        if(m_profiler)
+            m_profiler->end(m_section);
+    }
+
+    FrameProfiler::FrameProfiler() :
+        m_openCount(0),
+        m_frameStarted(Clock::now()),
+        m_history(FrameProfiler::HISTORY_FRAMES * SECTION_COUNT, 0),
+        m_sampled(FrameProfiler::HISTORY_FRAMES * SECTION_COUNT, 0),
+        m_nextFrame(0),
+        m_frameCount(0)
+    {
+        std::fill(m_currentFrame, m_currentFrame + SECTION_COUNT, 0);
+        std::fill(m_currentSampled, m_currentSampled + SECTION_COUNT, false);
+        m_sorted.reserve(FrameProfiler::HISTORY_FRAMES);
+    }
+
+    void FrameProfiler::begin(Section p_section)
+    {
+        m_sectionStarted[p_section] = Clock::now();
+        m_currentSampled[p_section] = true;
+
+        if(m_openCount < SECTION_COUNT)
+            m_openSections[m_openCount++] = p_section;
+    }
+
+    void FrameProfiler::end(Section p_section)
+    {
+        std::chrono::duration<double, std::milli> elapsed =
+            Clock::now() - m_sectionStarted[p_section];
+
+        m_currentFrame[p_section] += elapsed.count();
+
+        if(m_openCount > 0 && m_openSections[m_openCount - 1] == p_section)
+            m_openCount--;
+
+        // the section around this one only gets the time spent outside it
+        if(m_openCount > 0)
+            m_currentFrame[m_openSections[m_openCount - 1]] -= elapsed.count();
+    }
+
+    void FrameProfiler::endFrame()
+    {
+        Clock::time_point now = Clock::now();
+        m_currentFrame[SECTION_FRAME] =
+            std::chrono::duration<double, std::milli>(now - m_frameStarted).count();
+        m_currentSampled[SECTION_FRAME] = true;
+        m_frameStarted = now;
+
+        float* row = &m_history[m_nextFrame * SECTION_COUNT];
+        unsigned char* sampled = &m_sampled[m_nextFrame * SECTION_COUNT];
+        for(auto i = 0; i < SECTION_COUNT; i++)
+        {
+            row[i] = m_currentFrame[i];
+            sampled[i] = m_currentSampled[i];
+            m_currentFrame[i] = 0;
+            m_currentSampled[i] = false;
+        }
+
+        m_nextFrame = (m_nextFrame + 1) % FrameProfiler::HISTORY_FRAMES;
+        if(m_frameCount < FrameProfiler::HISTORY_FRAMES)
+            m_frameCount++;
+    }
+
+    FrameProfiler::Percentiles FrameProfiler::getPercentiles(Section p_section)
+    {
+        Percentiles percentiles = { 0, 0, 0 };
+
+        m_sorted.clear();
+        for(auto i = 0; i < m_frameCount; i++)
+        {
+            if(hasSample(i, p_section))
+                m_sorted.push_back(getFrameTime(i, p_section));
+        }
+
+        if(m_sorted.empty())
+            return percentiles;
+
+        std::sort(m_sorted.begin(), m_sorted.end());
+
+        // nearest rank
+        int last = m_sorted.size() - 1;
+        percentiles.m_p50 = m_sorted[last * 50 / 100];
+        percentiles.m_p95 = m_sorted[last * 95 / 100];
+        percentiles.m_p99 = m_sorted[last * 99 / 100];
+
+        return percentiles;
+    }
+
+    int FrameProfiler::getFrameCount() const
+    {
+        return m_frameCount;
+    }
+
+    int FrameProfiler::getSampleCount(Section p_section) const
+    {
+        int count = 0;
+        for(auto i = 0; i < m_frameCount; i++)
+        {
+            if(hasSample(i, p_section))
+                count++;
+        }
+
+        return count;
+    }
+
+    float FrameProfiler::getFrameTime(int p_frame, Section p_section) const
+    {
+        return m_history[getHistoryRow(p_frame) * SECTION_COUNT + p_section];
+    }
+
+    bool FrameProfiler::hasSample(int p_frame, Section p_section) const
+    {
+        return m_sampled[getHistoryRow(p_frame) * SECTION_COUNT + p_section] != 0;
+    }
+
+    int FrameProfiler::getHistoryRow(int p_frame) const
+    {
+        int oldest = m_frameCount < FrameProfiler::HISTORY_FRAMES ? 0 : m_nextFrame;
+        return (oldest + p_frame) % FrameProfiler::HISTORY_FRAMES;
+    }
+
+    const char* FrameProfiler::getSectionName(Section p_section)
+    {
+        static const char* names[SECTION_COUNT] =
+        {
+            "input",
+            "physics_step",
+            "motion_states",
+            "debug_draw",
+            "gui",
+            "render",
+            "frame"
+        };
+
+        return names[p_section];
+    }
+
+    void FrameProfiler::writeCsv(std::ostream& p_stream) const
+    {
+        p_stream << "frame";
+        for(auto i = 0; i < SECTION_COUNT; i++)
+            p_stream << "," << getSectionName(static_cast<Section>(i));
+        p_stream << "\n";
+
+        for(auto frame = 0; frame < m_frameCount; frame++)
+        {
+            p_stream << frame;
+            for(auto i = 0; i < SECTION_COUNT; i++)
+            {
+                p_stream << ",";
+                if(hasSample(frame, static_cast<Section>(i)))
+                    p_stream << getFrameTime(frame, static_cast<Section>(i));
+            }
+            p_stream << "\n";
+        }
+    }
+
+    void FrameProfiler::writeJson(std::ostream& p_stream)
+    {
+        p_stream << "{\n  \"percentiles\": {";
+        for(auto i = 0; i < SECTION_COUNT; i++)
+        {
+            Percentiles percentiles = getPercentiles(static_cast<Section>(i));
+
+            p_stream << (i > 0 ? "," : "") << "\n    \"" << getSectionName(static_cast<Section>(i))
+                     << "\": {\"frames\": " << getSampleCount(static_cast<Section>(i))
+                     << ", \"p50\": " << percentiles.m_p50
+                     << ", \"p95\": " << percentiles.m_p95
+                     << ", \"p99\": " << percentiles.m_p99 << "}";
+        }
+        p_stream << "\n  },\n  \"frames\": [";
+
+        for(auto frame = 0; frame < m_frameCount; frame++)
+        {
+            p_stream << (frame > 0 ? "," : "") << "\n    {";
+            for(auto i = 0; i < SECTION_COUNT; i++)
+            {
+                p_stream << (i > 0 ? ", " : "") << "\"" << getSectionName(static_cast<Section>(i))
+                         << "\": ";
+                if(hasSample(frame, static_cast<Section>(i)))
+                    p_stream << getFrameTime(frame, static_cast<Section>(i));
+                else
+                    p_stream << "null";
+            }
+            p_stream << "}";
+        }
+        p_stream << "\n  ]\n}\n";
+    }
+}
@@ -0,0 +1,133 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "FrozenFrame.hpp"
+
+#include <iostream>
+
+namespace TiltBall
+{
+    FrozenFrame::FrozenFrame() :
+        m_textureUnit(0),
+        m_overlay(0),
+        m_viewport(0),
+        m_visibilityMask(0)
+    {
+    }
+
+    void FrozenFrame::capture(Ogre::Viewport* p_viewport)
+    {
+        if(m_viewport)
+            return;
+
+        if(!m_overlay)
+            create();
+
+        // the window may have been resized since the last capture
+        int width = p_viewport->getActualWidth();
+        int height = p_viewport->getActualHeight();
+        if(m_texture.isNull() ||
+           static_cast<int>(m_texture->getWidth()) != width ||
+           static_cast<int>(m_texture->getHeight()) != height)
+            createTexture(width, height);
+
+        std::clog << "Freezing the scene..." << std::endl;
+
+        // overlays (and so the GUI, see GuiRenderQueueListener) are left
+        // out, they keep being drawn live on top
+        Ogre::RenderTarget* target = m_texture->getBuffer()->getRenderTarget();
+        Ogre::Viewport* viewport = target->addViewport(p_viewport->getCamera());
+        viewport->setBackgroundColour(p_viewport->getBackgroundColour());
+        viewport->setOverlaysEnabled(false);
+        target->update();
+        target->removeAllViewports();
+
+        m_viewport = p_viewport;
+        m_visibilityMask = p_viewport->getVisibilityMask();
+
+        // nothing in the scene matches, so only the overlays get drawn
+        p_viewport->setVisibilityMask(0);
+        m_overlay->show();
+    }
+
+    void FrozenFrame::release()
+    {
+        if(!m_viewport)
+            return;
+
+        m_overlay->hide();
+        m_viewport->setVisibilityMask(m_visibilityMask);
+        m_viewport = 0;
+    }
+
+    bool FrozenFrame::isCaptured() const
+    {
+        return m_viewport != 0;
+    }
+
+    void FrozenFrame::create()
+    {
+        Ogre::MaterialPtr material = Ogre::MaterialManager::getSingleton().create(
+            "Materials/FrozenFrame",
+            Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+        Ogre::Pass* pass = material->getTechnique(0)->getPass(0);
+        pass->setLightingEnabled(false);
+        pass->setDepthCheckEnabled(false);
+        pass->setDepthWriteEnabled(false);
+        m_textureUnit = pass->createTextureUnitState();
+
+        Ogre::OverlayManager& overlayManager = Ogre::OverlayManager::getSingleton();
+        Ogre::OverlayContainer* panel = static_cast<Ogre::OverlayContainer*>(
+            overlayManager.createOverlayElement("Panel", "FrozenFramePanel"));
+        panel->setMetricsMode(Ogre::GMM_RELATIVE);
+        panel->setPosition(0, 0);
+        panel->setDimensions(1, 1);
+        panel->setMaterialName("Materials/FrozenFrame");
+
+        // below the fade and profiler overlays
+        m_overlay = overlayManager.create("Overlays/FrozenFrame");
+        m_overlay->setZOrder(0);
+        m_overlay->add2D(panel);
+    }
+
+    void FrozenFrame::createTexture(int p_width, int p_height)
+    {
+        Ogre::TextureManager& textureManager = Ogre::TextureManager::getSingleton();
+
+        if(!m_texture.isNull())
+        {
+            m_textureUnit->setBlank();
+            textureManager.remove(m_texture->getHandle());
+            m_texture.setNull();
+        }
+
+        m_texture = textureManager.createManual(
+            "frozen_frame",
+            Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+            Ogre::TEX_TYPE_2D,
+            p_width,
+            p_height,
+            0,
+            Ogre::PF_R8G8B8,
+            Ogre::TU_RENDERTARGET);
+        m_texture->getBuffer()->getRenderTarget()->setAutoUpdated(false);
+
+        m_textureUnit->setTextureName("frozen_frame");
+    }
+}
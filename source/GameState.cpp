@@ -30,4 +30,14 @@ namespace TiltBall
     GameState::~GameState()
     {
     }
+
+    GameState::PausedRendering GameState::getPausedRendering() const
+    {
+        return PAUSED_RENDER_LIVE;
+    }
+
+    bool GameState::needsContinuousRendering() const
+    {
+        return true;
+    }
 }
@@ -0,0 +1,48 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GuiRenderQueueListener.hpp"
+
+#include <CEGUI/CEGUI.h>
+
+namespace TiltBall
+{
+    GuiRenderQueueListener::GuiRenderQueueListener(FrameProfiler* p_profiler) :
+        m_profiler(p_profiler)
+    {
+    }
+
+    void GuiRenderQueueListener::renderQueueEnded(Ogre::uint8 p_queueGroupId,
+                                                  const Ogre::String& p_invocation,
+                                                  bool& p_repeatThisInvocation)
+    {
+        if(p_queueGroupId != Ogre::RENDER_QUEUE_OVERLAY)
+            return;
+
+        // the GUI goes wherever the overlays do, which leaves it out of a
+        // frozen frame (see FrozenFrame)
+        Ogre::Viewport* viewport = Ogre::Root::getSingleton().getRenderSystem()->_getViewport();
+        if(viewport && !viewport->getOverlaysEnabled())
+            return;
+
+        FrameProfiler::Scope scope(m_profiler, FrameProfiler::SECTION_GUI);
+        CEGUI::System::getSingleton().renderGUI();
+    }
+}
@@ -0,0 +1,118 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Simulation.hpp"
+#include "TiltScript.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    TiltBall::LevelCollider::ColliderType colliderType = TiltBall::LevelCollider::COLLIDER_COMPOUND;
+    bool printEvents = false;
+
+    std::vector<const char*> arguments;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--mesh-collider") == 0)
+            colliderType = TiltBall::LevelCollider::COLLIDER_TRIANGLE_MESH;
+        else if(std::strcmp(argv[i], "--events") == 0)
+            printEvents = true;
+        else
+            arguments.push_back(argv[i]);
+    }
+
+    if(arguments.size() < 1 || arguments.size() > 3)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--mesh-collider] [--events] <level file> [tilt script] [seconds]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        // level loading is chatty, and there is no log file to send it to
+        // when running thousands of simulations side by side
+        std::clog.rdbuf(0);
+
+        TiltBall::TiltScript script;
+        if(arguments.size() >= 2)
+            script.load(arguments[1]);
+
+        float maxSeconds = arguments.size() == 3 ? atof(arguments[2]) : 60;
+
+        TiltBall::Simulation simulation(arguments[0], script, colliderType);
+        if(printEvents)
+            simulation.setEventLog(&std::cout);
+
+        auto start = std::chrono::steady_clock::now();
+        TiltBall::Simulation::Outcome outcome = simulation.run(maxSeconds);
+        auto end = std::chrono::steady_clock::now();
+
+        double wallSeconds = std::chrono::duration<double>(end - start).count();
+
+        std::cout << "level: " << arguments[0] << std::endl;
+
+        switch(outcome)
+        {
+        case TiltBall::Simulation::OUTCOME_TARGET_REACHED:
+            std::cout << "outcome: target reached" << std::endl;
+            break;
+
+        case TiltBall::Simulation::OUTCOME_BALL_FELL_OFF:
+            std::cout << "outcome: ball fell off" << std::endl;
+            break;
+
+        default:
+            std::cout << "outcome: timed out" << std::endl;
+            break;
+        }
+
+        btVector3 ballPosition = simulation.getBallPosition();
+
+        std::cout << "ball position: " << ballPosition.x() << ' ' << ballPosition.y() << ' '
+                  << ballPosition.z() << std::endl;
+        std::cout << "wall impacts: " << simulation.getWallImpactCount() << std::endl;
+        std::cout << "steps: " << simulation.getStepCount() << std::endl;
+        std::cout << "simulated seconds: " << simulation.getSimulatedTime() << std::endl;
+        std::cout << "wall clock seconds: " << wallSeconds << std::endl;
+
+        if(wallSeconds > 0)
+        {
+            std::cout << "steps per second: " << simulation.getStepCount() / wallSeconds
+                      << std::endl;
+            std::cout << "speedup over real time: "
+                      << simulation.getSimulatedTime() / wallSeconds << 'x' << std::endl;
+        }
+    }
+    catch(std::exception& error)
+    {
+        std::cerr << "ERROR: " << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -33,6 +33,8 @@ namespace TiltBall
         InputSystem* inputSystem = m_engine->getInputSystem();
         inputSystem->capture();
 
+        m_engine->loadResourceGroup("General");
+
         // get the material by name
         std::clog << "Loading fade overlay material..." << std::endl;
         Ogre::ResourcePtr resptr = Ogre::MaterialManager::getSingleton().
@@ -83,6 +85,10 @@ namespace TiltBall
         return true;
     }
 
+    void IntroState::simulate(float p_elapsed)
+    {
+    }
+
     bool IntroState::mouseMoved(const OIS::MouseEvent& evt)
     {
         return true;
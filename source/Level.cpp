@@ -21,27 +21,28 @@
 #include "Level.hpp"
 #include "Engine.hpp"
 #include "OgreMotionState.hpp"
+#include "Trace.hpp"
 
-#include <algorithm>
-#include <fstream>
 #include <sstream>
-#include <cmath>
+#include <stdint.h>
 #include <vector>
 #include <boost/regex.hpp>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
 
 namespace TiltBall
 {
-    Level::Level(Engine* p_engine, std::string p_fileName) :
+    Level::Level(Engine* p_engine, std::shared_ptr<PreparedLevel> p_preparedLevel) :
         m_level(initSceneNode(p_engine, "level")),
         m_ball(initSceneNode(p_engine, "ball")),
         m_target(initSceneNode(p_engine, "target")),
         m_engine(p_engine),
-        m_extrusion(0.0003),
-        m_fileName(p_fileName)
+        m_preparedLevel(p_preparedLevel),
+        m_description(p_preparedLevel->getDescription()),
+        m_wallInstances(0),
+        m_physics(0)
     {
-        load(p_fileName);
+        TraceZone zone("Level::Level");
+
+        m_engine->loadResourceGroup("General");
 
         std::clog << "Setting up camera..." << std::endl;
         Ogre::Camera* camera = m_engine->getOgreRoot()->getSceneManager("main_scene_manager")->
@@ -51,7 +52,9 @@ namespace TiltBall
         camera->setFarClipDistance(500.0f);
         camera->setAutoAspectRatio(true);
         camera->setFOVy(Ogre::Degree(70.0f));
-        camera->setPosition(m_cameraX, m_cameraY, m_cameraZ);
+        camera->setPosition(m_description.getCameraX(),
+                            m_description.getCameraY(),
+                            m_description.getCameraZ());
         camera->lookAt(0, 0, 0);
 
         std::clog << "Setting up viewport..." << std::endl;
@@ -62,90 +65,157 @@ namespace TiltBall
 
         buildLevel();
         buildBall();
+
+        // add level, target and ball to the physics world; the motion states
+        // move the scene nodes along with the bodies
+        m_physics = new LevelPhysics(m_engine->getPhysicsWorld(),
+                                     m_description,
+                                     m_preparedLevel->getCollider(),
+                                     new OgreMotionState(m_level),
+                                     new OgreMotionState(m_ball));
     }
 
     void Level::buildLevel()
     {
-        // bottom surface and walls all go into a compound shape,
-        // making the level; the target is a separate shape so we can
-        // test for collision separately
-        btCompoundShape* compoundShape = new btCompoundShape();
+        Ogre::SceneManager* sceneManager = m_engine->getOgreRoot()->
+            getSceneManager("main_scene_manager");
+
+        // the floor and all the walls go into one object, with a single
+        // section (and so a single draw call) per material
+        const LevelGeometry& bottomSurface = m_preparedLevel->getBottomSurface();
+        const LevelGeometry& walls = m_preparedLevel->getWalls();
+
+        Ogre::ManualObject* level = sceneManager->createManualObject("level_geometry");
+        addSection(level, "Materials/Level1Floor", bottomSurface);
+        if(m_preparedLevel->hasWallGeometry())
+            addSection(level, "Materials/Level1Wall", walls);
+        else
+            buildInstancedWalls(sceneManager);
+        m_level->attachObject(level);
+
+        // the target moves on its own, so it keeps an object of its own
+        Ogre::ManualObject* targetObject = sceneManager->createManualObject("target");
+        addSection(targetObject, "Materials/Target", m_preparedLevel->getTarget());
+        m_target->attachObject(targetObject);
+        m_target->setPosition(m_description.getTargetX(),
+                              m_description.getTargetY(),
+                              m_description.getTargetZ());
+
+        std::clog << "Level geometry: " << bottomSurface.getVertices().size() +
+            walls.getVertices().size() << " vertices, " << (bottomSurface.getIndices().size() +
+            walls.getIndices().size()) / 3 << " triangles" << std::endl;
+
+        // add level + target to the graphics world
+        m_level->addChild(m_target);
+        sceneManager->getRootSceneNode()->addChild(m_level);
+
+        updateWalls();
+    }
 
-        std::vector<WorldObject> bottomSurface = buildBottomSurface("Materials/Level1Floor");
-        for(auto it = bottomSurface.begin(); it < bottomSurface.end(); it++)
+    void Level::buildInstancedWalls(Ogre::SceneManager* p_sceneManager)
+    {
+        const std::vector<BoxCoordinates>& wallBoxes = m_preparedLevel->getWallBoxes();
+
+        std::clog << "Instancing " << wallBoxes.size() << " walls..." << std::endl;
+
+        // the unit box stays around for later levels
+        if(!Ogre::MeshManager::getSingleton().resourceExists("unit_wall_box"))
         {
-            m_level->attachObject((*it).getMovableObject());
-            compoundShape->addChildShape((*it).getTransform(),
-                                         (*it).getCollisionShape());
+            LevelGeometry unitBox;
+            unitBox.addBox(BoxCoordinates(-0.5, -0.5, -0.5, 0.5, 0.5, 0.5));
+            unitBox.build();
+
+            Ogre::ManualObject* manual = p_sceneManager->createManualObject("unit_wall_box");
+            addSection(manual, "Materials/Level1WallInstanced", unitBox);
+            manual->convertToMesh("unit_wall_box");
+            p_sceneManager->destroyManualObject(manual);
         }
 
-        std::vector<WorldObject> walls = buildWalls("Materials/Level1Wall");
-        for(auto it = walls.begin(); it < walls.end(); it++)
+        m_wallInstances = p_sceneManager->createInstanceManager("walls",
+                                                                "unit_wall_box",
+                                                                Ogre::ResourceGroupManager::
+                                                                DEFAULT_RESOURCE_GROUP_NAME,
+                                                                Ogre::InstanceManager::
+                                                                HWInstancingBasic,
+                                                                Level::WALL_INSTANCES_PER_BATCH);
+
+        // positioned relative to the level without any scene nodes; the
+        // shader puts them where the level is
+        for(auto it = wallBoxes.begin(); it < wallBoxes.end(); it++)
         {
-            m_level->attachObject((*it).getMovableObject());
-            compoundShape->addChildShape((*it).getTransform(),
-                                         (*it).getCollisionShape());
+            Ogre::InstancedEntity* wall =
+                p_sceneManager->createInstancedEntity("Materials/Level1WallInstanced", "walls");
+
+            wall->setPosition(Ogre::Vector3((it->getX1() + it->getX2()) / 2,
+                                            (it->getY1() + it->getY2()) / 2,
+                                            (it->getZ1() + it->getZ2()) / 2));
+            wall->setScale(Ogre::Vector3(it->getX2() - it->getX1(),
+                                         it->getY2() - it->getY1(),
+                                         it->getZ2() - it->getZ1()));
         }
 
-        WorldObject target = buildBox("target", "Materials/Target",
-                                      0 - Level::TARGET_HALF_SIZE,
-                                      0 - Level::TARGET_THICKNESS,
-                                      0 - Level::TARGET_HALF_SIZE,
-                                      Level::TARGET_HALF_SIZE,
-                                      Level::TARGET_THICKNESS,
-                                      Level::TARGET_HALF_SIZE);
-
-        m_target->attachObject(target.getMovableObject());
-        m_target->setPosition(m_levelXMin + m_targetX,
-                              m_levelYMin + Level::TARGET_THICKNESS / 2,
-                              m_levelZMin + m_targetZ);
-
-        // add level to physics world
-        m_collisionShapes.push_back(compoundShape);
-
-        m_levelBody = attachBodyToPhysicsWorld(m_level,
-                                               compoundShape,
-                                               0,
-                                               0,
-                                               0,
-                                               0);
-
-        // add target to physics world
-        m_targetBody = attachBodyToPhysicsWorld(m_target,
-                                                target.getCollisionShape(),
-                                                0,
-                                                m_levelXMin + m_targetX,
-                                                m_levelYMin + Level::TARGET_THICKNESS / 2,
-                                                m_levelZMin + m_targetZ);
+        // the walls never move relative to the level, so the instance data
+        // is written once
+        m_wallInstances->setBatchesAsStaticAndUpdate(true);
 
-        // add level + target to the graphics world
-        Ogre::SceneManager* sceneManager = m_engine->getOgreRoot()->
-            getSceneManager("main_scene_manager");
-        m_level->addChild(m_target);
-        sceneManager->getRootSceneNode()->addChild(m_level);
+        // moving the batches under the level node keeps their bounds (and
+        // so culling) in line with where the shader draws them
+        Ogre::InstanceManager::InstanceBatchIterator batches =
+            m_wallInstances->getInstanceBatchIterator("Materials/Level1WallInstanced");
+        while(batches.hasMoreElements())
+        {
+            Ogre::SceneNode* batchNode = batches.getNext()->getParentSceneNode();
+            if(batchNode && batchNode->getParentSceneNode())
+            {
+                batchNode->getParentSceneNode()->removeChild(batchNode);
+                m_level->addChild(batchNode);
+            }
+        }
+
+        Ogre::MaterialPtr material =
+            Ogre::MaterialManager::getSingleton().getByName("Materials/Level1WallInstanced");
+        m_wallParameters = material->getTechnique(0)->getPass(0)->getVertexProgramParameters();
+    }
+
+    void Level::updateWalls()
+    {
+        if(!m_wallInstances)
+            return;
+
+        m_wallParameters->setNamedConstant("levelMatrix", m_level->_getFullTransform());
+    }
+
+    bool Level::supportsInstancedWalls(Engine* p_engine)
+    {
+        const Ogre::RenderSystemCapabilities* capabilities =
+            p_engine->getOgreRoot()->getRenderSystem()->getCapabilities();
+        if(!capabilities->hasCapability(Ogre::RSC_VERTEX_BUFFER_INSTANCE_DATA))
+            return false;
+
+        p_engine->loadResourceGroup("General");
+
+        Ogre::MaterialPtr material =
+            Ogre::MaterialManager::getSingleton().getByName("Materials/Level1WallInstanced");
+        if(material.isNull())
+            return false;
+
+        material->load();
+
+        return material->getNumSupportedTechniques() > 0;
     }
 
     void Level::buildBall()
     {
         std::clog << "Creating ball..." << std::endl;
         Ogre::Entity* ball = m_engine->getOgreRoot()->getSceneManager("main_scene_manager")->
-            createEntity("ball", "meshes/sphere.mesh");
+            createEntity("ball", "sphere.mesh");
         ball->setMaterialName("Materials/Ball");
 
-        m_ball->setPosition(m_ballStartingX, 4, m_ballStartingZ);
+        m_ball->setPosition(m_description.getBallStartingX(),
+                            m_description.getBallStartingY(),
+                            m_description.getBallStartingZ());
         m_ball->attachObject(ball);
 
-        // add ball to physics world
-        btCollisionShape* sphereShape = new btSphereShape(btScalar(1.0f));
-        m_collisionShapes.push_back(sphereShape);
-
-        m_ballBody = attachBodyToPhysicsWorld(m_ball,
-                                              sphereShape,
-                                              50,
-                                              m_ballStartingX,
-                                              4,
-                                              m_ballStartingZ);
-
         // add ball to graphics world
         Ogre::SceneManager* sceneManager = m_engine->getOgreRoot()->
             getSceneManager("main_scene_manager");
@@ -154,34 +224,18 @@ namespace TiltBall
 
     Level::~Level()
     {
+        // removes the rigid bodies from the dynamics world and deletes them
+        delete m_physics;
+
+        if(m_wallInstances)
+            m_engine->getOgreRoot()->getSceneManager("main_scene_manager")->
+                destroyInstanceManager(m_wallInstances);
+
+        // the debug lines live in the scene too
+        m_engine->getDebugDrawer()->resetScene();
         m_engine->getOgreRoot()->getSceneManager("main_scene_manager")->clearScene();
         m_engine->getOgreRoot()->getSceneManager("main_scene_manager")->destroyAllCameras();
         m_engine->getOgreRoot()->getRenderTarget("main_window")->removeAllViewports();
-
-        //remove the rigidbodies from the dynamics world and delete them
-        btDiscreteDynamicsWorld* dynamicsWorld = m_engine->getDynamicsWorld();
-        for(auto i = dynamicsWorld->getNumCollisionObjects() - 1; i >= 0; i--)
-        {
-            btCollisionObject* object = dynamicsWorld->getCollisionObjectArray()[i];
-            btRigidBody* body = btRigidBody::upcast(object);
-
-            if(body)
-            {
-                if(body->getMotionState())
-                    delete body->getMotionState();
-
-                dynamicsWorld->removeRigidBody(body);
-            }
-            else
-                dynamicsWorld->removeCollisionObject(object);
-
-            delete object;
-        }
-
-        for(auto it = m_collisionShapes.begin(); it < m_collisionShapes.end(); it++)
-            delete (*it);
-
-        m_collisionShapes.clear();
     }
 
     Ogre::SceneNode* Level::initSceneNode(Engine* p_engine, std::string p_nodeName)
@@ -190,347 +244,62 @@ namespace TiltBall
             createSceneNode(p_nodeName);
     }
 
-    std::vector<WorldObject> Level::buildBottomSurface(std::string p_bottomMaterial)
+    void Level::addSection(Ogre::ManualObject* p_manual,
+                           std::string p_material,
+                           const LevelGeometry& p_geometry)
     {
-        std::clog << "Creating bottom surface..." << std::endl;
-
-        std::vector<WorldObject> bottomSurface;
-
-        bottomSurface.push_back(buildBox("bottom_surface_1", p_bottomMaterial,
-                                         m_levelXMin - Level::WALL_HALF_THICKNESS,
-                                         m_levelYMin,
-                                         m_levelZMin - Level::WALL_HALF_THICKNESS,
-                                         m_levelXMax + Level::WALL_HALF_THICKNESS,
-                                         m_levelYMax,
-                                         m_levelZMin + m_targetZ - Level::TARGET_HALF_SIZE));
-
-        bottomSurface.push_back(buildBox("bottom_surface_2", p_bottomMaterial,
-                                         m_levelXMin + m_targetX + Level::TARGET_HALF_SIZE,
-                                         m_levelYMin,
-                                         m_levelZMin + m_targetZ - Level::TARGET_HALF_SIZE,
-                                         m_levelXMax + Level::WALL_HALF_THICKNESS,
-                                         m_levelYMax,
-                                         m_levelZMax + Level::WALL_HALF_THICKNESS));
-
-        bottomSurface.push_back(buildBox("bottom_surface_3", p_bottomMaterial,
-                                         m_levelXMin - Level::WALL_HALF_THICKNESS,
-                                         m_levelYMin,
-                                         m_levelZMin + m_targetZ + Level::TARGET_HALF_SIZE,
-                                         m_levelXMin + m_targetX + Level::TARGET_HALF_SIZE,
-                                         m_levelYMax,
-                                         m_levelZMax + Level::WALL_HALF_THICKNESS));
-
-        bottomSurface.push_back(buildBox("bottom_surface_4", p_bottomMaterial,
-                                         m_levelXMin - Level::WALL_HALF_THICKNESS,
-                                         m_levelYMin,
-                                         m_levelZMin + m_targetZ - Level::TARGET_HALF_SIZE,
-                                         m_levelXMin + m_targetX - Level::TARGET_HALF_SIZE,
-                                         m_levelYMax,
-                                         m_levelZMin + m_targetZ + Level::TARGET_HALF_SIZE));
-
-        return bottomSurface;
-    }
+        const std::vector<LevelGeometry::Vertex>& vertices = p_geometry.getVertices();
+        const std::vector<uint32_t>& indices = p_geometry.getIndices();
 
-    std::vector<WorldObject> Level::buildWalls(std::string p_material)
-    {
-        std::clog << "Creating walls..." << std::endl;
+        if(indices.empty())
+            return;
+
+        p_manual->estimateVertexCount(vertices.size());
+        p_manual->estimateIndexCount(indices.size());
 
-        std::vector<WorldObject> walls;
+        p_manual->begin(p_material, Ogre::RenderOperation::OT_TRIANGLE_LIST);
 
-        int wallNumber = 0;
-        for(auto it = m_walls.begin(); it < m_walls.end(); it++, wallNumber++)
+        for(auto it = vertices.begin(); it < vertices.end(); it++)
         {
-            std::ostringstream wallNameStream;
-            wallNameStream << "wall" << wallNumber;
-
-            int p_pointBeginX = (*it).getBeginX();
-            int p_pointBeginZ = (*it).getBeginZ();
-            int p_pointEndX = (*it).getEndX();
-            int p_pointEndZ = (*it).getEndZ();
-
-            if (p_pointBeginX > p_pointEndX)
-                std::swap(p_pointBeginX, p_pointEndX);
-            if (p_pointBeginZ > p_pointEndZ)
-                std::swap(p_pointBeginZ, p_pointEndZ);
-
-            float wallX1 = m_levelXMin + p_pointBeginX - Level::WALL_HALF_THICKNESS - m_extrusion;
-            float wallX2 = m_levelXMin + p_pointEndX + Level::WALL_HALF_THICKNESS + m_extrusion;
-            float wallY1 = m_levelYMax - m_extrusion;
-            float wallY2 = m_levelYMax + Level::WALL_HEIGHT + m_extrusion;
-            float wallZ1 = m_levelZMin + p_pointBeginZ - Level::WALL_HALF_THICKNESS - m_extrusion;
-            float wallZ2 = m_levelZMin + p_pointEndZ + Level::WALL_HALF_THICKNESS + m_extrusion;
-
-            // slight extrusion prevents depth fighting of overlapping wall ends
-            m_extrusion += 0.0003;
-
-            walls.push_back(buildBox(wallNameStream.str(),
-                                     p_material,
-                                     wallX1,
-                                     wallY1,
-                                     wallZ1,
-                                     wallX2,
-                                     wallY2,
-                                     wallZ2));
+            p_manual->position(it->m_position[0], it->m_position[1], it->m_position[2]);
+            p_manual->normal(it->m_normal[0], it->m_normal[1], it->m_normal[2]);
+            p_manual->textureCoord(it->m_textureCoord[0], it->m_textureCoord[1]);
         }
 
-        return walls;
-    }
+        // ManualObject switches to 32 bit indices by itself once an index
+        // does not fit in 16 bits
+        for(auto it = indices.begin(); it < indices.end(); it++)
+            p_manual->index(*it);
 
-    WorldObject Level::buildBox(std::string p_name,
-                                std::string p_material,
-                                float p_x1,
-                                float p_y1,
-                                float p_z1,
-                                float p_x2,
-                                float p_y2,
-                                float p_z2)
-    {
-        Ogre::ManualObject* manual = m_engine->getOgreRoot()->
-            getSceneManager("main_scene_manager")->createManualObject(p_name);
-        manual->begin(p_material);
-
-        // these two variables are used to avoid texture distortion when the face is not square
-        float uMax = 1;
-        float vMax = 1;
-
-        // bottom face
-        uMax = (p_x2 - p_x1);
-        vMax = (p_z2 - p_z1);
-        manual->position(p_x1, p_y1, p_z1);
-        manual->textureCoord(0, vMax);
-        manual->normal(0, -1, 0);
-
-        manual->position(p_x2, p_y1, p_z1);
-        manual->textureCoord(uMax, vMax);
-        manual->normal(0, -1, 0);
-
-        manual->position(p_x2, p_y1, p_z2);
-        manual->textureCoord(uMax, 0);
-        manual->normal(0, -1, 0);
-
-        manual->position(p_x1, p_y1, p_z2);
-        manual->textureCoord(0, 0);
-        manual->normal(0, -1, 0);
-
-        // top face
-        manual->position(p_x1, p_y2, p_z2);
-        manual->textureCoord(0, 0);
-        manual->normal(0, 1, 0);
-
-        manual->position(p_x2, p_y2, p_z2);
-        manual->textureCoord(uMax, 0);
-        manual->normal(0, 1, 0);
-
-        manual->position(p_x2, p_y2, p_z1);
-        manual->textureCoord(uMax, vMax);
-        manual->normal(0, 1, 0);
-
-        manual->position(p_x1, p_y2, p_z1);
-        manual->textureCoord(0, vMax);
-        manual->normal(0, 1, 0);
-
-        // front face
-        uMax = (p_x2 - p_x1);
-        vMax = (p_y2 - p_y1);
-
-        manual->position(p_x1, p_y1, p_z2);
-        manual->textureCoord(0, 0);
-        manual->normal(0, 0, 1);
-
-        manual->position(p_x2, p_y1, p_z2);
-        manual->textureCoord(uMax, 0);
-        manual->normal(0, 0, 1);
-
-        manual->position(p_x2, p_y2, p_z2);
-        manual->textureCoord(uMax, vMax);
-        manual->normal(0, 0, 1);
-
-        manual->position(p_x1, p_y2, p_z2);
-        manual->textureCoord(0, vMax);
-        manual->normal(0, 0, 1);
-
-        // back face
-        manual->position(p_x1, p_y2, p_z1);
-        manual->textureCoord(0, vMax);
-        manual->normal(0, 0, -1);
-
-        manual->position(p_x2, p_y2, p_z1);
-        manual->textureCoord(uMax, vMax);
-        manual->normal(0, 0, -1);
-
-        manual->position(p_x2, p_y1, p_z1);
-        manual->textureCoord(uMax, 0);
-        manual->normal(0, 0, -1);
-
-        manual->position(p_x1, p_y1, p_z1);
-        manual->textureCoord(0, 0);
-        manual->normal(0, 0, -1);
-
-        // left face
-        uMax = (p_y2 - p_y1);
-        vMax = (p_z2 - p_z1);
-        manual->position(p_x1, p_y1, p_z2);
-        manual->textureCoord(0, 0);
-        manual->normal(-1, 0, 0);
-
-        manual->position(p_x1, p_y2, p_z2);
-        manual->textureCoord(uMax, 0);
-        manual->normal(-1, 0, 0);
-
-        manual->position(p_x1, p_y2, p_z1);
-        manual->textureCoord(uMax, vMax);
-        manual->normal(-1, 0, 0);
-
-        manual->position(p_x1, p_y1, p_z1);
-        manual->textureCoord(0, vMax);
-        manual->normal(-1, 0, 0);
-
-        // right face
-        manual->position(p_x2, p_y1, p_z1);
-        manual->textureCoord(0, vMax);
-        manual->normal(1, 0, 0);
-
-        manual->position(p_x2, p_y2, p_z1);
-        manual->textureCoord(uMax, vMax);
-        manual->normal(1, 0, 0);
-
-        manual->position(p_x2, p_y2, p_z2);
-        manual->textureCoord(uMax, 0);
-        manual->normal(1, 0, 0);
-
-        manual->position(p_x2, p_y1, p_z2);
-        manual->textureCoord(0, 0);
-        manual->normal(1, 0, 0);
-
-        // bottom face
-        manual->quad(0, 1, 2, 3);
-        // top face
-        manual->quad(4, 5, 6, 7);
-        // front face
-        manual->quad(8, 9, 10, 11);
-        // back face
-        manual->quad(12, 13, 14, 15);
-        // left face
-        manual->quad(16, 17, 18, 19);
-        // right face
-        manual->quad(20, 21, 22, 23);
-
-        manual->end();
-
-        btCollisionShape* boxShape = new btBoxShape(btVector3(((p_x2 - p_x1) / 2),
-                                                              ((p_y2 - p_y1) / 2),
-                                                              ((p_z2 - p_z1) / 2)));
-
-        m_collisionShapes.push_back(boxShape);
-
-        btTransform boxTransform;
-        boxTransform.setIdentity();
-        boxTransform.setOrigin(btVector3(((p_x2 + p_x1) / 2),
-                                         ((p_y2 + p_y1) / 2),
-                                         ((p_z2 + p_z1) / 2)));
-
-        return WorldObject(manual, boxShape, boxTransform);
+        p_manual->end();
     }
 
-    btRigidBody* Level::attachBodyToPhysicsWorld(Ogre::SceneNode* p_sceneNode,
-                                                 btCollisionShape* p_collisionShape,
-                                                 float p_mass,
-                                                 float p_originX,
-                                                 float p_originY,
-                                                 float p_originZ)
+    void Level::reset()
     {
-        btTransform transform;
-        transform.setIdentity();
-        transform.setOrigin(btVector3(p_originX, p_originY, p_originZ));
-
-        btScalar mass(p_mass);
-        btVector3 localInertia(0, 0, 0);
-        if(p_mass > 0)
-            p_collisionShape->calculateLocalInertia(mass, localInertia);
-
-        OgreMotionState* motionState = new OgreMotionState(transform, p_sceneNode);
-
-        btRigidBody::btRigidBodyConstructionInfo info(mass,
-                                                      motionState,
-                                                      p_collisionShape,
-                                                      localInertia);
-
-        btRigidBody* body = new btRigidBody(info);
-
-        body->setRestitution(0);
-        body->setFriction(0.2);
-
-        if(p_mass == 0)
-        {
-            body->setCollisionFlags(body->getCollisionFlags() |
-                                    btCollisionObject::CF_KINEMATIC_OBJECT);
-            body->setActivationState(DISABLE_DEACTIVATION);
-        }
-
-        body->setUserPointer(p_sceneNode);
-
-        m_engine->getDynamicsWorld()->addRigidBody(body);
-
-        return body;
+        m_physics->reset();
+
+        // the motion states only move the nodes after the next physics
+        // step, and the level node is where the tilt input accumulates
+        m_level->setOrientation(Ogre::Quaternion::IDENTITY);
+        m_ball->setOrientation(Ogre::Quaternion::IDENTITY);
+        m_ball->setPosition(m_description.getBallStartingX(),
+                            m_description.getBallStartingY(),
+                            m_description.getBallStartingZ());
     }
 
-    void Level::load(std::string p_fileName)
+    LevelPhysics* Level::getPhysics()
     {
-        std::clog << "Loading level..." << std::endl;
-
-        boost::property_tree::ptree pt;
-        read_json(p_fileName, pt);
-
-        m_name = pt.get<std::string>("name");
-
-        std::clog << "Level name: " << m_name << std::endl;
-
-        m_levelXMin = -(pt.get<float>("dimensions.x") / 2);
-        m_levelXMax = pt.get<float>("dimensions.x") / 2;
-        m_levelZMin = -(pt.get<float>("dimensions.z") / 2);
-        m_levelZMax = pt.get<float>("dimensions.z") / 2;
-        m_levelYMin = -1;
-        m_levelYMax = 1;
-
-        std::clog << "Level dimensions: " <<
-            pt.get<float>("dimensions.x") << 'x' <<
-            pt.get<float>("dimensions.z") << std::endl;
-
-        m_cameraX = pt.get<float>("camera.x");
-        m_cameraY = pt.get<float>("camera.y");
-        m_cameraZ = pt.get<float>("camera.z");
-
-        m_targetX = pt.get<float>("target.x");
-        m_targetZ = pt.get<float>("target.z");
-
-        std::clog << "Target coordinates: " << m_targetX << ' ' << m_targetZ << std::endl;
-
-        m_ballStartingX = pt.get<float>("ball.x");
-        m_ballStartingZ = pt.get<float>("ball.z");
-
-        std::clog << "Ball coordinates: " << m_ballStartingX << ' ' << m_ballStartingZ << std::endl;
-
-        std::clog << "Loading walls..." << std::endl;
-        for(auto it = pt.get_child("walls").begin(); it != pt.get_child("walls").end(); it++)
-            m_walls.push_back(WallCoordinates((*it).second.get<float>("begin.x"),
-                                              (*it).second.get<float>("begin.z"),
-                                              (*it).second.get<float>("end.x"),
-                                              (*it).second.get<float>("end.z")));
+        return m_physics;
     }
 
     btRigidBody* Level::getLevelBody()
     {
-        return m_levelBody;
+        return m_physics->getLevelBody();
     }
 
     btRigidBody* Level::getBallBody()
     {
-        return m_ballBody;
-    }
-
-    btRigidBody* Level::getTargetBody()
-    {
-        return m_targetBody;
+        return m_physics->getBallBody();
     }
 
     Ogre::SceneNode* Level::getLevelNode()
@@ -550,19 +319,26 @@ namespace TiltBall
 
     std::string Level::getFileName()
     {
-        return m_fileName;
+        return m_preparedLevel->getFileName();
+    }
+
+    std::shared_ptr<PreparedLevel> Level::getPreparedLevel()
+    {
+        return m_preparedLevel;
     }
 
     std::string Level::getNextLevelFileName()
     {
-        boost::regex regex("(.*)level([[:digit:]]+)\\.json");
+        // the next level is in the same format as the current one
+        boost::regex regex("(.*)level([[:digit:]]+)\\.(json|level)");
         boost::smatch matches;
-        regex_search(m_fileName, matches, regex);
+        std::string fileName = m_preparedLevel->getFileName();
+        regex_search(fileName, matches, regex);
 
         int levelNumber = atoi(matches[2].str().c_str());
 
         std::stringstream stream;
-        stream << matches[1] << "level" << levelNumber + 1 << ".json";
+        stream << matches[1] << "level" << levelNumber + 1 << '.' << matches[3];
 
         return stream.str();
     }
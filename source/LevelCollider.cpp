@@ -0,0 +1,263 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LevelCollider.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
+
+namespace TiltBall
+{
+    // BVH files start with this header; the BVH follows in Bullet's in
+    // place serialization format, which wants 16 byte alignment
+    struct BvhFileHeader
+    {
+        char m_magic[4];
+        uint32_t m_version;
+        // hash of the level file the BVH was built for
+        uint64_t m_levelHash;
+        uint32_t m_vertexCount;
+        uint32_t m_triangleCount;
+        uint32_t m_bvhSize;
+        uint32_t m_padding;
+    };
+
+    static_assert(sizeof(BvhFileHeader) % 16 == 0, "BVH data after the header must stay aligned");
+
+    static const char BVH_MAGIC[4] = { 'T', 'B', 'V', 'H' };
+
+    // bumped whenever the level triangles could come out differently for
+    // the same level file
+    static const uint32_t BVH_VERSION = 2;
+
+    LevelCollider::LevelCollider(const LevelDescription& p_description,
+                                 ColliderType p_colliderType,
+                                 std::string p_bvhFileName) :
+        m_colliderType(p_colliderType),
+        m_shape(0),
+        m_geometry(0),
+        m_mesh(0),
+        m_triangleInfoMap(0),
+        m_bvhBuffer(0),
+        m_loadedBvh(0)
+    {
+        std::clog << "Creating level collision shapes..." << std::endl;
+
+        if(m_colliderType == COLLIDER_TRIANGLE_MESH)
+            buildTriangleMeshShape(p_description, p_bvhFileName);
+        else
+            buildCompoundShape(p_description);
+    }
+
+    LevelCollider::~LevelCollider()
+    {
+        delete m_shape;
+
+        for(auto it = m_childShapes.begin(); it < m_childShapes.end(); it++)
+            delete (*it);
+
+        // the loaded BVH was built in place and does not own any memory,
+        // its buffer is freed below
+        if(m_loadedBvh)
+            m_loadedBvh->~btOptimizedBvh();
+        btAlignedFree(m_bvhBuffer);
+
+        delete m_triangleInfoMap;
+        delete m_mesh;
+        delete m_geometry;
+    }
+
+    LevelCollider::ColliderType LevelCollider::getColliderType() const
+    {
+        return m_colliderType;
+    }
+
+    btCollisionShape* LevelCollider::getShape()
+    {
+        return m_shape;
+    }
+
+    void LevelCollider::buildCompoundShape(const LevelDescription& p_description)
+    {
+        btCompoundShape* compoundShape = new btCompoundShape();
+        m_shape = compoundShape;
+
+        std::vector<BoxCoordinates> bottomSurface = p_description.buildBottomSurfaceBoxes();
+        for(auto it = bottomSurface.begin(); it < bottomSurface.end(); it++)
+            compoundShape->addChildShape(buildBoxTransform(*it), buildBoxShape(*it));
+
+        std::vector<BoxCoordinates> walls = p_description.buildWallBoxes();
+        for(auto it = walls.begin(); it < walls.end(); it++)
+            compoundShape->addChildShape(buildBoxTransform(*it), buildBoxShape(*it));
+    }
+
+    void LevelCollider::buildTriangleMeshShape(const LevelDescription& p_description,
+                                               std::string p_bvhFileName)
+    {
+        // the same triangles the level is drawn with, with the faces hidden
+        // between boxes already gone
+        m_geometry = new LevelGeometry();
+
+        std::vector<BoxCoordinates> bottomSurface = p_description.buildBottomSurfaceBoxes();
+        for(auto it = bottomSurface.begin(); it < bottomSurface.end(); it++)
+            m_geometry->addBox(*it);
+
+        std::vector<BoxCoordinates> walls = p_description.buildWallBoxes();
+        for(auto it = walls.begin(); it < walls.end(); it++)
+            m_geometry->addBox(*it);
+
+        m_geometry->build();
+
+        const std::vector<LevelGeometry::Vertex>& vertices = m_geometry->getVertices();
+        const std::vector<uint32_t>& indices = m_geometry->getIndices();
+
+        // positions are picked out of the interleaved vertices by stride
+        btIndexedMesh mesh;
+        mesh.m_numTriangles = indices.size() / 3;
+        mesh.m_triangleIndexBase = reinterpret_cast<const unsigned char*>(indices.data());
+        mesh.m_triangleIndexStride = 3 * sizeof(uint32_t);
+        mesh.m_numVertices = vertices.size();
+        mesh.m_vertexBase = reinterpret_cast<const unsigned char*>(vertices.data()->m_position);
+        mesh.m_vertexStride = sizeof(LevelGeometry::Vertex);
+        mesh.m_indexType = PHY_INTEGER;
+        mesh.m_vertexType = PHY_FLOAT;
+
+        m_mesh = new btTriangleIndexVertexArray();
+        m_mesh->addIndexedMesh(mesh, PHY_INTEGER);
+
+        btBvhTriangleMeshShape* meshShape;
+
+        if(!p_bvhFileName.empty() && loadBvh(p_bvhFileName, p_description.getFileHash()))
+        {
+            std::clog << "Loaded level BVH from " << p_bvhFileName << std::endl;
+            meshShape = new btBvhTriangleMeshShape(m_mesh, true, false);
+            meshShape->setOptimizedBvh(m_loadedBvh);
+            m_shape = meshShape;
+        }
+        else
+        {
+            meshShape = new btBvhTriangleMeshShape(m_mesh, true, true);
+            m_shape = meshShape;
+
+            if(!p_bvhFileName.empty())
+                saveBvh(p_bvhFileName, p_description.getFileHash());
+        }
+
+        m_triangleInfoMap = new btTriangleInfoMap();
+        // the physics world corrects contacts against it using this map
+        btGenerateInternalEdgeInfo(meshShape, m_triangleInfoMap);
+
+        std::clog << "Level collision mesh: " << mesh.m_numTriangles << " triangles" << std::endl;
+    }
+
+    // fails quietly for files that are missing or were written for another
+    // level file, the BVH is then simply built again
+    bool LevelCollider::loadBvh(std::string p_fileName, uint64_t p_levelHash)
+    {
+        std::ifstream stream(p_fileName.c_str(), std::ios::binary);
+        if(!stream.good())
+            return false;
+
+        BvhFileHeader header;
+        if(!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+           std::memcmp(header.m_magic, BVH_MAGIC, 4) != 0 ||
+           header.m_version != BVH_VERSION ||
+           header.m_levelHash != p_levelHash ||
+           header.m_vertexCount != m_geometry->getVertices().size() ||
+           header.m_triangleCount != m_geometry->getIndices().size() / 3)
+            return false;
+
+        void* buffer = btAlignedAlloc(header.m_bvhSize, 16);
+        if(!stream.read(static_cast<char*>(buffer), header.m_bvhSize))
+        {
+            btAlignedFree(buffer);
+            return false;
+        }
+
+        btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(buffer, header.m_bvhSize, false);
+        if(!bvh)
+        {
+            btAlignedFree(buffer);
+            return false;
+        }
+
+        m_bvhBuffer = buffer;
+        m_loadedBvh = bvh;
+
+        return true;
+    }
+
+    // a cache that cannot be written only costs the time to build the BVH
+    // next time, so failures are logged and otherwise ignored
+    void LevelCollider::saveBvh(std::string p_fileName, uint64_t p_levelHash)
+    {
+        btOptimizedBvh* bvh = static_cast<btBvhTriangleMeshShape*>(m_shape)->getOptimizedBvh();
+
+        BvhFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.m_magic, BVH_MAGIC, 4);
+        header.m_version = BVH_VERSION;
+        header.m_levelHash = p_levelHash;
+        header.m_vertexCount = m_geometry->getVertices().size();
+        header.m_triangleCount = m_geometry->getIndices().size() / 3;
+        header.m_bvhSize = bvh->calculateSerializeBufferSize();
+
+        void* buffer = btAlignedAlloc(header.m_bvhSize, 16);
+        bool serialized = bvh->serializeInPlace(buffer, header.m_bvhSize, false);
+
+        std::ofstream stream(p_fileName.c_str(), std::ios::binary | std::ios::trunc);
+        if(serialized && stream.good())
+        {
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(static_cast<const char*>(buffer), header.m_bvhSize);
+        }
+
+        if(!serialized || !stream.good())
+            std::clog << "Could not write level BVH to " << p_fileName << std::endl;
+
+        btAlignedFree(buffer);
+    }
+
+    btCollisionShape* LevelCollider::buildBoxShape(const BoxCoordinates& p_box)
+    {
+        btCollisionShape* boxShape =
+            new btBoxShape(btVector3(((p_box.getX2() - p_box.getX1()) / 2),
+                                     ((p_box.getY2() - p_box.getY1()) / 2),
+                                     ((p_box.getZ2() - p_box.getZ1()) / 2)));
+
+        m_childShapes.push_back(boxShape);
+
+        return boxShape;
+    }
+
+    btTransform LevelCollider::buildBoxTransform(const BoxCoordinates& p_box)
+    {
+        btTransform boxTransform;
+        boxTransform.setIdentity();
+        boxTransform.setOrigin(btVector3(((p_box.getX2() + p_box.getX1()) / 2),
+                                         ((p_box.getY2() + p_box.getY1()) / 2),
+                                         ((p_box.getZ2() + p_box.getZ1()) / 2)));
+
+        return boxTransform;
+    }
+}
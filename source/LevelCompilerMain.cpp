@@ -0,0 +1,55 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LevelDescription.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+// compiles JSON levels into the binary level format, which loads without any
+// parsing; any level file the game reads can be given as input
+int main(int argc, char *argv[])
+{
+    if(argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input level> <output level>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::clog.rdbuf(0);
+
+        TiltBall::LevelDescription description;
+        description.load(argv[1]);
+        description.saveBinary(argv[2]);
+
+        std::cout << argv[1] << " -> " << argv[2] << " ("
+                  << description.getWallCount() << " walls)" << std::endl;
+    }
+    catch(std::exception& error)
+    {
+        std::cerr << "ERROR: " << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
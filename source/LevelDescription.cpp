@@ -0,0 +1,564 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LevelDescription.hpp"
+#include "AssetPack.hpp"
+#include "LevelParser.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <type_traits>
+
+namespace TiltBall
+{
+    // binary levels start with this header, followed by the level name
+    // padded to a multiple of four bytes and then the walls exactly as
+    // WallCoordinates lays them out in memory; everything is in the byte
+    // order of the machine that compiled the level
+    struct BinaryLevelHeader
+    {
+        char m_magic[4];
+        uint32_t m_version;
+        float m_dimensionX;
+        float m_dimensionZ;
+        float m_cameraX;
+        float m_cameraY;
+        float m_cameraZ;
+        float m_targetX;
+        float m_targetZ;
+        float m_ballX;
+        float m_ballZ;
+        uint32_t m_nameLength;
+        uint32_t m_wallCount;
+    };
+
+    static_assert(sizeof(BinaryLevelHeader) % 4 == 0 &&
+                  sizeof(WallCoordinates) == 4 * sizeof(int32_t) &&
+                  std::is_standard_layout<WallCoordinates>::value,
+                  "binary level layout does not match WallCoordinates");
+
+    static const char BINARY_MAGIC[4] = { 'T', 'B', 'L', 'V' };
+
+    static std::size_t paddedNameSize(std::size_t p_nameLength)
+    {
+        return (p_nameLength + 3) / 4 * 4;
+    }
+
+    // walls lie on a unit grid and are exactly one unit thick, so the boxes
+    // of walls one unit apart touch and a wall covers whole grid cells
+    static_assert(2 * LevelDescription::WALL_HALF_THICKNESS == 1,
+                  "wall merging assumes walls one grid cell thick");
+
+    // a wall along one axis: m_line is the coordinate on the other axis,
+    // m_from and m_to its extent
+    struct WallSegment
+    {
+        int m_line;
+        int m_from;
+        int m_to;
+    };
+
+    static bool lessSegment(const WallSegment& p_first, const WallSegment& p_second)
+    {
+        if(p_first.m_line != p_second.m_line)
+            return p_first.m_line < p_second.m_line;
+        return p_first.m_from < p_second.m_from;
+    }
+
+    // sorts the segments and joins those on the same line whose boxes touch
+    // or overlap
+    static void mergeSegments(std::vector<WallSegment>& p_segments)
+    {
+        if(p_segments.empty())
+            return;
+
+        std::sort(p_segments.begin(), p_segments.end(), lessSegment);
+
+        auto merged = p_segments.begin();
+        for(auto it = p_segments.begin() + 1; it < p_segments.end(); it++)
+        {
+            if(it->m_line == merged->m_line && it->m_from <= merged->m_to + 1)
+                merged->m_to = std::max(merged->m_to, it->m_to);
+            else
+                *++merged = *it;
+        }
+
+        p_segments.erase(merged + 1, p_segments.end());
+    }
+
+    // FNV-1a, 64 bit
+    static uint64_t hashFile(const MappedFile& p_file)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(p_file.getData());
+        uint64_t hash = 14695981039346656037ULL;
+        for(std::size_t i = 0; i < p_file.getSize(); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    LevelDescription::LevelDescription() :
+        m_fileHash(0),
+        m_mappedWalls(0),
+        m_mappedWallCount(0),
+        m_levelYMin(0),
+        m_levelYMax(0),
+        m_levelXMin(0),
+        m_levelXMax(0),
+        m_levelZMin(0),
+        m_levelZMax(0),
+        m_targetX(0),
+        m_targetZ(0),
+        m_ballStartingX(0),
+        m_ballStartingZ(0),
+        m_cameraX(0),
+        m_cameraY(0),
+        m_cameraZ(0)
+    {
+    }
+
+    void LevelDescription::load(std::string p_fileName)
+    {
+        TraceZone zone("LevelDescription::load");
+
+        std::clog << "Loading level..." << std::endl;
+
+        m_walls.clear();
+        m_mappedFile.reset();
+        m_mappedWalls = 0;
+        m_mappedWallCount = 0;
+
+        // a level in the asset pack is a view into its mapping, which
+        // works just as well for the walls of binary levels
+        std::shared_ptr<MappedFile> file = AssetPack::openFile(p_fileName);
+        m_fileHash = hashFile(*file);
+
+        if(!loadBinary(file))
+            loadJson(*file, p_fileName);
+
+        logSummary();
+    }
+
+    void LevelDescription::loadJson(const MappedFile& p_file, std::string p_fileName)
+    {
+        LevelParser parser(p_file.getData(), p_file.getData() + p_file.getSize(), p_fileName);
+        parser.parse();
+
+        m_name = parser.getName();
+
+        setDimensions(parser.getDimensionX(), parser.getDimensionZ());
+
+        m_cameraX = parser.getCameraX();
+        m_cameraY = parser.getCameraY();
+        m_cameraZ = parser.getCameraZ();
+
+        m_targetX = parser.getTargetX();
+        m_targetZ = parser.getTargetZ();
+
+        m_ballStartingX = parser.getBallX();
+        m_ballStartingZ = parser.getBallZ();
+
+        m_walls.swap(parser.getWalls());
+
+        mergeWalls();
+    }
+
+    bool LevelDescription::loadBinary(std::shared_ptr<MappedFile> p_file)
+    {
+        const char* data = p_file->getData();
+        std::size_t size = p_file->getSize();
+
+        if(size < sizeof(BinaryLevelHeader) || std::memcmp(data, BINARY_MAGIC, 4) != 0)
+            return false;
+
+        const BinaryLevelHeader* header = reinterpret_cast<const BinaryLevelHeader*>(data);
+
+        if(header->m_version != LevelDescription::BINARY_VERSION)
+            throw std::runtime_error("Unsupported binary level version");
+
+        std::size_t nameSize = paddedNameSize(header->m_nameLength);
+        std::size_t wallsOffset = sizeof(BinaryLevelHeader) + nameSize;
+
+        if(size < wallsOffset ||
+           (size - wallsOffset) / sizeof(WallCoordinates) < header->m_wallCount)
+            throw std::runtime_error("Truncated binary level");
+
+        m_name.assign(data + sizeof(BinaryLevelHeader), header->m_nameLength);
+
+        setDimensions(header->m_dimensionX, header->m_dimensionZ);
+
+        m_cameraX = header->m_cameraX;
+        m_cameraY = header->m_cameraY;
+        m_cameraZ = header->m_cameraZ;
+
+        m_targetX = header->m_targetX;
+        m_targetZ = header->m_targetZ;
+
+        m_ballStartingX = header->m_ballX;
+        m_ballStartingZ = header->m_ballZ;
+
+        // no copying, the walls are used right where they are in the mapping
+        m_mappedFile = p_file;
+        m_mappedWalls = reinterpret_cast<const WallCoordinates*>(data + wallsOffset);
+        m_mappedWallCount = header->m_wallCount;
+
+        return true;
+    }
+
+    void LevelDescription::saveBinary(std::string p_fileName) const
+    {
+        BinaryLevelHeader header;
+        std::memcpy(header.m_magic, BINARY_MAGIC, 4);
+        header.m_version = LevelDescription::BINARY_VERSION;
+        header.m_dimensionX = m_levelXMax - m_levelXMin;
+        header.m_dimensionZ = m_levelZMax - m_levelZMin;
+        header.m_cameraX = m_cameraX;
+        header.m_cameraY = m_cameraY;
+        header.m_cameraZ = m_cameraZ;
+        header.m_targetX = m_targetX;
+        header.m_targetZ = m_targetZ;
+        header.m_ballX = m_ballStartingX;
+        header.m_ballZ = m_ballStartingZ;
+        header.m_nameLength = m_name.size();
+        header.m_wallCount = getWallCount();
+
+        std::ofstream stream(p_fileName.c_str(), std::ios::binary | std::ios::trunc);
+        if(!stream.good())
+            throw std::runtime_error("Could not open " + p_fileName + " for writing");
+
+        std::vector<char> name(paddedNameSize(m_name.size()), 0);
+        std::copy(m_name.begin(), m_name.end(), name.begin());
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(&name[0], name.size());
+        stream.write(reinterpret_cast<const char*>(getWalls()),
+                     getWallCount() * sizeof(WallCoordinates));
+
+        if(!stream.good())
+            throw std::runtime_error("Could not write " + p_fileName);
+    }
+
+    void LevelDescription::mergeWalls()
+    {
+        std::vector<WallSegment> alongX;
+        std::vector<WallSegment> alongZ;
+        std::vector<WallCoordinates> diagonal;
+
+        for(auto it = m_walls.begin(); it < m_walls.end(); it++)
+        {
+            int beginX = std::min(it->getBeginX(), it->getEndX());
+            int endX = std::max(it->getBeginX(), it->getEndX());
+            int beginZ = std::min(it->getBeginZ(), it->getEndZ());
+            int endZ = std::max(it->getBeginZ(), it->getEndZ());
+
+            // single cell pillars start out along x
+            if(beginZ == endZ)
+                alongX.push_back(WallSegment { beginZ, beginX, endX });
+            else if(beginX == endX)
+                alongZ.push_back(WallSegment { beginX, beginZ, endZ });
+            else
+                diagonal.push_back(WallCoordinates(beginX, beginZ, endX, endZ));
+        }
+
+        mergeSegments(alongX);
+
+        // pillars that did not join anything along x may still extend or
+        // sit inside a wall along z
+        auto pillars = std::stable_partition(alongX.begin(), alongX.end(),
+                                             [](const WallSegment& p_segment)
+                                             {
+                                                 return p_segment.m_from != p_segment.m_to;
+                                             });
+        for(auto it = pillars; it < alongX.end(); it++)
+            alongZ.push_back(WallSegment { it->m_from, it->m_line, it->m_line });
+        alongX.erase(pillars, alongX.end());
+
+        mergeSegments(alongZ);
+
+        std::size_t originalCount = m_walls.size();
+
+        m_walls.clear();
+        m_walls.reserve(alongX.size() + alongZ.size() + diagonal.size());
+
+        for(auto it = alongX.begin(); it < alongX.end(); it++)
+            m_walls.push_back(WallCoordinates(it->m_from, it->m_line, it->m_to, it->m_line));
+
+        for(auto it = alongZ.begin(); it < alongZ.end(); it++)
+            m_walls.push_back(WallCoordinates(it->m_line, it->m_from, it->m_line, it->m_to));
+
+        m_walls.insert(m_walls.end(), diagonal.begin(), diagonal.end());
+
+        std::clog << "Merged " << originalCount << " walls into " << m_walls.size() << std::endl;
+    }
+
+    void LevelDescription::setDimensions(float p_dimensionX, float p_dimensionZ)
+    {
+        m_levelXMin = -(p_dimensionX / 2);
+        m_levelXMax = p_dimensionX / 2;
+        m_levelZMin = -(p_dimensionZ / 2);
+        m_levelZMax = p_dimensionZ / 2;
+        m_levelYMin = -1;
+        m_levelYMax = 1;
+    }
+
+    void LevelDescription::logSummary() const
+    {
+        std::clog << "Level name: " << m_name << std::endl;
+        std::clog << "Level dimensions: " <<
+            m_levelXMax - m_levelXMin << 'x' <<
+            m_levelZMax - m_levelZMin << std::endl;
+        std::clog << "Target coordinates: " << m_targetX << ' ' << m_targetZ << std::endl;
+        std::clog << "Ball coordinates: " << m_ballStartingX << ' ' << m_ballStartingZ << std::endl;
+        std::clog << "Walls: " << getWallCount() << std::endl;
+    }
+
+    std::vector<BoxCoordinates> LevelDescription::buildBottomSurfaceBoxes() const
+    {
+        std::vector<BoxCoordinates> boxes;
+
+        // four boxes around the hole the target sits in
+        boxes.push_back(BoxCoordinates(m_levelXMin - LevelDescription::WALL_HALF_THICKNESS,
+                                       m_levelYMin,
+                                       m_levelZMin - LevelDescription::WALL_HALF_THICKNESS,
+                                       m_levelXMax + LevelDescription::WALL_HALF_THICKNESS,
+                                       m_levelYMax,
+                                       m_levelZMin + m_targetZ -
+                                       LevelDescription::TARGET_HALF_SIZE));
+
+        boxes.push_back(BoxCoordinates(m_levelXMin + m_targetX +
+                                       LevelDescription::TARGET_HALF_SIZE,
+                                       m_levelYMin,
+                                       m_levelZMin + m_targetZ -
+                                       LevelDescription::TARGET_HALF_SIZE,
+                                       m_levelXMax + LevelDescription::WALL_HALF_THICKNESS,
+                                       m_levelYMax,
+                                       m_levelZMax + LevelDescription::WALL_HALF_THICKNESS));
+
+        boxes.push_back(BoxCoordinates(m_levelXMin - LevelDescription::WALL_HALF_THICKNESS,
+                                       m_levelYMin,
+                                       m_levelZMin + m_targetZ +
+                                       LevelDescription::TARGET_HALF_SIZE,
+                                       m_levelXMin + m_targetX +
+                                       LevelDescription::TARGET_HALF_SIZE,
+                                       m_levelYMax,
+                                       m_levelZMax + LevelDescription::WALL_HALF_THICKNESS));
+
+        boxes.push_back(BoxCoordinates(m_levelXMin - LevelDescription::WALL_HALF_THICKNESS,
+                                       m_levelYMin,
+                                       m_levelZMin + m_targetZ -
+                                       LevelDescription::TARGET_HALF_SIZE,
+                                       m_levelXMin + m_targetX -
+                                       LevelDescription::TARGET_HALF_SIZE,
+                                       m_levelYMax,
+                                       m_levelZMin + m_targetZ +
+                                       LevelDescription::TARGET_HALF_SIZE));
+
+        return boxes;
+    }
+
+    std::vector<BoxCoordinates> LevelDescription::buildWallBoxes() const
+    {
+        std::vector<BoxCoordinates> boxes;
+        boxes.reserve(getWallCount());
+
+        const WallCoordinates* walls = getWalls();
+        std::size_t wallCount = getWallCount();
+
+        // the cells covered by walls along x (pillars included), looked up
+        // when cutting walls along z
+        std::vector<WallSegment> alongX;
+        for(auto it = walls; it < walls + wallCount; it++)
+        {
+            if(it->getBeginZ() == it->getEndZ())
+                alongX.push_back(WallSegment { it->getBeginZ(),
+                                               std::min(it->getBeginX(), it->getEndX()),
+                                               std::max(it->getBeginX(), it->getEndX()) });
+        }
+        std::sort(alongX.begin(), alongX.end(), lessSegment);
+
+        auto isCovered = [&alongX](int p_x, int p_z)
+        {
+            WallSegment cell = { p_z, p_x, p_x };
+            auto after = std::upper_bound(alongX.begin(), alongX.end(), cell, lessSegment);
+            if(after == alongX.begin())
+                return false;
+            --after;
+            return after->m_line == p_z && after->m_to >= p_x;
+        };
+
+        float wallY1 = m_levelYMax;
+        float wallY2 = m_levelYMax + LevelDescription::WALL_HEIGHT;
+
+        for(auto it = walls; it < walls + wallCount; it++)
+        {
+            int beginX = std::min(it->getBeginX(), it->getEndX());
+            int endX = std::max(it->getBeginX(), it->getEndX());
+            int beginZ = std::min(it->getBeginZ(), it->getEndZ());
+            int endZ = std::max(it->getBeginZ(), it->getEndZ());
+
+            if(beginX != endX || beginZ == endZ)
+            {
+                boxes.push_back(BoxCoordinates(
+                    m_levelXMin + beginX - LevelDescription::WALL_HALF_THICKNESS,
+                    wallY1,
+                    m_levelZMin + beginZ - LevelDescription::WALL_HALF_THICKNESS,
+                    m_levelXMin + endX + LevelDescription::WALL_HALF_THICKNESS,
+                    wallY2,
+                    m_levelZMin + endZ + LevelDescription::WALL_HALF_THICKNESS));
+                continue;
+            }
+
+            // a wall along z gets one box per run of cells not already
+            // covered by a wall along x, so the boxes only ever touch and
+            // there are no overlapping faces to fight over the depth buffer
+            int runBegin = beginZ;
+            for(int z = beginZ; z <= endZ + 1; z++)
+            {
+                if(z <= endZ && !isCovered(beginX, z))
+                    continue;
+
+                if(z > runBegin)
+                    boxes.push_back(BoxCoordinates(
+                        m_levelXMin + beginX - LevelDescription::WALL_HALF_THICKNESS,
+                        wallY1,
+                        m_levelZMin + runBegin - LevelDescription::WALL_HALF_THICKNESS,
+                        m_levelXMin + beginX + LevelDescription::WALL_HALF_THICKNESS,
+                        wallY2,
+                        m_levelZMin + z - 1 + LevelDescription::WALL_HALF_THICKNESS));
+
+                runBegin = z + 1;
+            }
+        }
+
+        return boxes;
+    }
+
+    BoxCoordinates LevelDescription::buildTargetBox() const
+    {
+        return BoxCoordinates(0 - LevelDescription::TARGET_HALF_SIZE,
+                              0 - LevelDescription::TARGET_THICKNESS,
+                              0 - LevelDescription::TARGET_HALF_SIZE,
+                              LevelDescription::TARGET_HALF_SIZE,
+                              LevelDescription::TARGET_THICKNESS,
+                              LevelDescription::TARGET_HALF_SIZE);
+    }
+
+    std::string LevelDescription::getName() const
+    {
+        return m_name;
+    }
+
+    uint64_t LevelDescription::getFileHash() const
+    {
+        return m_fileHash;
+    }
+
+    const WallCoordinates* LevelDescription::getWalls() const
+    {
+        return m_mappedFile ? m_mappedWalls : m_walls.data();
+    }
+
+    std::size_t LevelDescription::getWallCount() const
+    {
+        return m_mappedFile ? m_mappedWallCount : m_walls.size();
+    }
+
+    float LevelDescription::getLevelXMin() const
+    {
+        return m_levelXMin;
+    }
+
+    float LevelDescription::getLevelXMax() const
+    {
+        return m_levelXMax;
+    }
+
+    float LevelDescription::getLevelYMin() const
+    {
+        return m_levelYMin;
+    }
+
+    float LevelDescription::getLevelYMax() const
+    {
+        return m_levelYMax;
+    }
+
+    float LevelDescription::getLevelZMin() const
+    {
+        return m_levelZMin;
+    }
+
+    float LevelDescription::getLevelZMax() const
+    {
+        return m_levelZMax;
+    }
+
+    float LevelDescription::getTargetX() const
+    {
+        return m_levelXMin + m_targetX;
+    }
+
+    float LevelDescription::getTargetY() const
+    {
+        return m_levelYMin + LevelDescription::TARGET_THICKNESS / 2;
+    }
+
+    float LevelDescription::getTargetZ() const
+    {
+        return m_levelZMin + m_targetZ;
+    }
+
+    float LevelDescription::getBallStartingX() const
+    {
+        return m_ballStartingX;
+    }
+
+    float LevelDescription::getBallStartingY() const
+    {
+        return LevelDescription::BALL_STARTING_HEIGHT;
+    }
+
+    float LevelDescription::getBallStartingZ() const
+    {
+        return m_ballStartingZ;
+    }
+
+    float LevelDescription::getCameraX() const
+    {
+        return m_cameraX;
+    }
+
+    float LevelDescription::getCameraY() const
+    {
+        return m_cameraY;
+    }
+
+    float LevelDescription::getCameraZ() const
+    {
+        return m_cameraZ;
+    }
+}
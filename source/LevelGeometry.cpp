@@ -0,0 +1,232 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LevelGeometry.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace TiltBall
+{
+    // FNV-1a over the raw bytes; keys are made of floats that are
+    // compared bitwise, so hashing their bits is consistent with that
+    static std::size_t hashBytes(const void* p_data, std::size_t p_size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(p_data);
+        uint64_t hash = 14695981039346656037ULL;
+        for(std::size_t i = 0; i < p_size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+
+    // turns -0 into 0 so that bitwise comparison treats them alike
+    static float normalizeZero(float p_value)
+    {
+        return p_value + 0.0f;
+    }
+
+    static bool lessPosition(const float* p_first, const float* p_second)
+    {
+        return std::lexicographical_compare(p_first, p_first + 3, p_second, p_second + 3);
+    }
+
+    std::size_t LevelGeometry::FaceKeyHash::operator()(const FaceKey& p_key) const
+    {
+        return hashBytes(p_key.m_corners, sizeof(p_key.m_corners));
+    }
+
+    bool LevelGeometry::FaceKeyEqual::operator()(const FaceKey& p_first,
+                                                 const FaceKey& p_second) const
+    {
+        return std::memcmp(p_first.m_corners, p_second.m_corners, sizeof(p_first.m_corners)) == 0;
+    }
+
+    std::size_t LevelGeometry::VertexHash::operator()(const Vertex& p_vertex) const
+    {
+        return hashBytes(&p_vertex, sizeof(p_vertex));
+    }
+
+    bool LevelGeometry::VertexEqual::operator()(const Vertex& p_first,
+                                                const Vertex& p_second) const
+    {
+        return std::memcmp(&p_first, &p_second, sizeof(p_first)) == 0;
+    }
+
+    LevelGeometry::LevelGeometry()
+    {
+    }
+
+    void LevelGeometry::addBox(const BoxCoordinates& p_box)
+    {
+        float x1 = p_box.getX1();
+        float y1 = p_box.getY1();
+        float z1 = p_box.getZ1();
+        float x2 = p_box.getX2();
+        float y2 = p_box.getY2();
+        float z2 = p_box.getZ2();
+
+        // texture coordinates follow the face dimensions so that textures
+        // are not distorted on faces that are not square
+        float width = x2 - x1;
+        float height = y2 - y1;
+        float depth = z2 - z1;
+
+        {
+            float corners[4][3] = { { x1, y1, z1 }, { x2, y1, z1 }, { x2, y1, z2 }, { x1, y1, z2 } };
+            float normal[3] = { 0, -1, 0 };
+            float textureCoords[4][2] = { { 0, depth }, { width, depth }, { width, 0 }, { 0, 0 } };
+            addFace(corners, normal, textureCoords);
+        }
+
+        {
+            float corners[4][3] = { { x1, y2, z2 }, { x2, y2, z2 }, { x2, y2, z1 }, { x1, y2, z1 } };
+            float normal[3] = { 0, 1, 0 };
+            float textureCoords[4][2] = { { 0, 0 }, { width, 0 }, { width, depth }, { 0, depth } };
+            addFace(corners, normal, textureCoords);
+        }
+
+        {
+            float corners[4][3] = { { x1, y1, z2 }, { x2, y1, z2 }, { x2, y2, z2 }, { x1, y2, z2 } };
+            float normal[3] = { 0, 0, 1 };
+            float textureCoords[4][2] = { { 0, 0 }, { width, 0 }, { width, height }, { 0, height } };
+            addFace(corners, normal, textureCoords);
+        }
+
+        {
+            float corners[4][3] = { { x1, y2, z1 }, { x2, y2, z1 }, { x2, y1, z1 }, { x1, y1, z1 } };
+            float normal[3] = { 0, 0, -1 };
+            float textureCoords[4][2] = { { 0, height }, { width, height }, { width, 0 }, { 0, 0 } };
+            addFace(corners, normal, textureCoords);
+        }
+
+        {
+            float corners[4][3] = { { x1, y1, z2 }, { x1, y2, z2 }, { x1, y2, z1 }, { x1, y1, z1 } };
+            float normal[3] = { -1, 0, 0 };
+            float textureCoords[4][2] = { { 0, 0 }, { height, 0 }, { height, depth }, { 0, depth } };
+            addFace(corners, normal, textureCoords);
+        }
+
+        {
+            float corners[4][3] = { { x2, y1, z1 }, { x2, y2, z1 }, { x2, y2, z2 }, { x2, y1, z2 } };
+            float normal[3] = { 1, 0, 0 };
+            float textureCoords[4][2] = { { 0, depth }, { height, depth }, { height, 0 }, { 0, 0 } };
+            addFace(corners, normal, textureCoords);
+        }
+    }
+
+    void LevelGeometry::addFace(const float p_corners[4][3],
+                                const float p_normal[3],
+                                const float p_textureCoords[4][2])
+    {
+        Face face;
+        face.m_hidden = false;
+
+        for(int i = 0; i < 4; i++)
+        {
+            Vertex& vertex = face.m_corners[i];
+            for(int j = 0; j < 3; j++)
+            {
+                vertex.m_position[j] = normalizeZero(p_corners[i][j]);
+                vertex.m_normal[j] = normalizeZero(p_normal[j]);
+            }
+            vertex.m_textureCoord[0] = normalizeZero(p_textureCoords[i][0]);
+            vertex.m_textureCoord[1] = normalizeZero(p_textureCoords[i][1]);
+        }
+
+        // the same four corners in any order and facing either way
+        const float* sorted[4] = { face.m_corners[0].m_position,
+                                   face.m_corners[1].m_position,
+                                   face.m_corners[2].m_position,
+                                   face.m_corners[3].m_position };
+        std::sort(sorted, sorted + 4, lessPosition);
+
+        FaceKey key;
+        for(int i = 0; i < 4; i++)
+            std::memcpy(key.m_corners + 3 * i, sorted[i], 3 * sizeof(float));
+
+        auto found = m_faceIndices.find(key);
+        if(found != m_faceIndices.end())
+        {
+            Face& other = m_faces[found->second];
+
+            // facing each other, the two faces are sandwiched between their
+            // boxes and can never be seen; facing the same way, one of them
+            // is enough
+            if(std::memcmp(other.m_corners[0].m_normal, face.m_corners[0].m_normal,
+                           sizeof(face.m_corners[0].m_normal)) != 0)
+                other.m_hidden = true;
+
+            return;
+        }
+
+        m_faceIndices[key] = m_faces.size();
+        m_faces.push_back(face);
+    }
+
+    void LevelGeometry::build()
+    {
+        m_vertices.clear();
+        m_indices.clear();
+
+        std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> vertexIndices;
+
+        for(auto it = m_faces.begin(); it < m_faces.end(); it++)
+        {
+            if(it->m_hidden)
+                continue;
+
+            uint32_t corners[4];
+            for(int i = 0; i < 4; i++)
+            {
+                auto found = vertexIndices.find(it->m_corners[i]);
+                if(found == vertexIndices.end())
+                {
+                    corners[i] = m_vertices.size();
+                    vertexIndices[it->m_corners[i]] = corners[i];
+                    m_vertices.push_back(it->m_corners[i]);
+                }
+                else
+                    corners[i] = found->second;
+            }
+
+            // two triangles per face, wound the same way as the corners
+            m_indices.push_back(corners[0]);
+            m_indices.push_back(corners[1]);
+            m_indices.push_back(corners[2]);
+
+            m_indices.push_back(corners[0]);
+            m_indices.push_back(corners[2]);
+            m_indices.push_back(corners[3]);
+        }
+    }
+
+    const std::vector<LevelGeometry::Vertex>& LevelGeometry::getVertices() const
+    {
+        return m_vertices;
+    }
+
+    const std::vector<uint32_t>& LevelGeometry::getIndices() const
+    {
+        return m_indices;
+    }
+}
@@ -0,0 +1,705 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LevelParser.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace TiltBall
+{
+    static const double POWERS_OF_TEN[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    static std::string describeError(std::string p_sourceName,
+                                     int p_line,
+                                     int p_column,
+                                     std::string p_message)
+    {
+        std::ostringstream stream;
+        stream << p_sourceName << ":" << p_line << ":" << p_column << ": " << p_message;
+        return stream.str();
+    }
+
+    LevelParseError::LevelParseError(std::string p_sourceName,
+                                     int p_line,
+                                     int p_column,
+                                     std::string p_message) :
+        std::runtime_error(describeError(p_sourceName, p_line, p_column, p_message)),
+        m_line(p_line),
+        m_column(p_column)
+    {
+    }
+
+    int LevelParseError::getLine() const
+    {
+        return m_line;
+    }
+
+    int LevelParseError::getColumn() const
+    {
+        return m_column;
+    }
+
+    LevelParser::LevelParser(const char* p_begin, const char* p_end, std::string p_sourceName) :
+        m_begin(p_begin),
+        m_end(p_end),
+        m_position(p_begin),
+        m_sourceName(p_sourceName),
+        m_key(0),
+        m_keyLength(0),
+        m_dimensionX(0),
+        m_dimensionZ(0),
+        m_cameraX(0),
+        m_cameraY(0),
+        m_cameraZ(0),
+        m_targetX(0),
+        m_targetZ(0),
+        m_ballX(0),
+        m_ballZ(0)
+    {
+    }
+
+    void LevelParser::parse()
+    {
+        m_position = m_begin;
+        m_walls.clear();
+
+        // every wall is three objects (the wall, its begin and its end), so
+        // counting braces gives a close upper bound on the wall count
+        // without a second parse; memchr goes through the buffer far faster
+        // than the parser itself can
+        std::size_t braces = 0;
+        if(m_begin != m_end)
+        {
+            for(const char* it = m_begin;
+                (it = static_cast<const char*>(std::memchr(it, '{', m_end - it))) != 0;
+                it++)
+                braces++;
+        }
+        m_walls.reserve(braces / 3);
+
+        skipWhitespace();
+        parseLevel();
+        skipWhitespace();
+
+        if(m_position != m_end)
+            fail(m_position, "unexpected text after the level object");
+    }
+
+    std::string LevelParser::getName() const
+    {
+        return m_name;
+    }
+
+    float LevelParser::getDimensionX() const
+    {
+        return m_dimensionX;
+    }
+
+    float LevelParser::getDimensionZ() const
+    {
+        return m_dimensionZ;
+    }
+
+    float LevelParser::getCameraX() const
+    {
+        return m_cameraX;
+    }
+
+    float LevelParser::getCameraY() const
+    {
+        return m_cameraY;
+    }
+
+    float LevelParser::getCameraZ() const
+    {
+        return m_cameraZ;
+    }
+
+    float LevelParser::getTargetX() const
+    {
+        return m_targetX;
+    }
+
+    float LevelParser::getTargetZ() const
+    {
+        return m_targetZ;
+    }
+
+    float LevelParser::getBallX() const
+    {
+        return m_ballX;
+    }
+
+    float LevelParser::getBallZ() const
+    {
+        return m_ballZ;
+    }
+
+    std::vector<WallCoordinates>& LevelParser::getWalls()
+    {
+        return m_walls;
+    }
+
+    void LevelParser::parseLevel()
+    {
+        const char* start = m_position;
+        bool hasName = false;
+        bool hasDimensions = false;
+        bool hasCamera = false;
+        bool hasTarget = false;
+        bool hasBall = false;
+        bool hasWalls = false;
+
+        expect('{');
+        if(!consume('}'))
+        {
+            do
+            {
+                parseKey();
+
+                if(isKey("name"))
+                {
+                    m_name = parseString();
+                    hasName = true;
+                }
+                else if(isKey("dimensions"))
+                {
+                    parsePoint(&m_dimensionX, 0, &m_dimensionZ);
+                    hasDimensions = true;
+                }
+                else if(isKey("camera"))
+                {
+                    parsePoint(&m_cameraX, &m_cameraY, &m_cameraZ);
+                    hasCamera = true;
+                }
+                else if(isKey("target"))
+                {
+                    parsePoint(&m_targetX, 0, &m_targetZ);
+                    hasTarget = true;
+                }
+                else if(isKey("ball"))
+                {
+                    parsePoint(&m_ballX, 0, &m_ballZ);
+                    hasBall = true;
+                }
+                else if(isKey("walls"))
+                {
+                    parseWalls();
+                    hasWalls = true;
+                }
+                else
+                    skipValue(0);
+            }
+            while(consume(','));
+
+            expect('}');
+        }
+
+        if(!hasName)
+            fail(start, "level has no \"name\"");
+        if(!hasDimensions)
+            fail(start, "level has no \"dimensions\"");
+        if(!hasCamera)
+            fail(start, "level has no \"camera\"");
+        if(!hasTarget)
+            fail(start, "level has no \"target\"");
+        if(!hasBall)
+            fail(start, "level has no \"ball\"");
+        if(!hasWalls)
+            fail(start, "level has no \"walls\"");
+
+        if(m_dimensionX <= 0 || m_dimensionZ <= 0)
+            fail(start, "level dimensions must be positive");
+    }
+
+    // reads an object with "x", "y" and "z" members; p_y is null for
+    // objects that only have "x" and "z"
+    void LevelParser::parsePoint(float* p_x, float* p_y, float* p_z)
+    {
+        const char* start = m_position;
+        bool hasX = false;
+        bool hasY = false;
+        bool hasZ = false;
+
+        expect('{');
+        if(!consume('}'))
+        {
+            do
+            {
+                parseKey();
+
+                if(isKey("x"))
+                {
+                    *p_x = parseNumber();
+                    hasX = true;
+                }
+                else if(p_y != 0 && isKey("y"))
+                {
+                    *p_y = parseNumber();
+                    hasY = true;
+                }
+                else if(isKey("z"))
+                {
+                    *p_z = parseNumber();
+                    hasZ = true;
+                }
+                else
+                    skipValue(0);
+            }
+            while(consume(','));
+
+            expect('}');
+        }
+
+        if(!hasX)
+            fail(start, "object has no \"x\"");
+        if(p_y != 0 && !hasY)
+            fail(start, "object has no \"y\"");
+        if(!hasZ)
+            fail(start, "object has no \"z\"");
+    }
+
+    void LevelParser::parseWalls()
+    {
+        expect('[');
+        if(consume(']'))
+            return;
+
+        do
+            parseWall();
+        while(consume(','));
+
+        expect(']');
+    }
+
+    void LevelParser::parseWall()
+    {
+        const char* start = m_position;
+        bool hasBegin = false;
+        bool hasEnd = false;
+        float beginX = 0;
+        float beginZ = 0;
+        float endX = 0;
+        float endZ = 0;
+
+        expect('{');
+        if(!consume('}'))
+        {
+            do
+            {
+                parseKey();
+
+                if(isKey("begin"))
+                {
+                    parsePoint(&beginX, 0, &beginZ);
+                    hasBegin = true;
+                }
+                else if(isKey("end"))
+                {
+                    parsePoint(&endX, 0, &endZ);
+                    hasEnd = true;
+                }
+                else
+                    skipValue(0);
+            }
+            while(consume(','));
+
+            expect('}');
+        }
+
+        if(!hasBegin)
+            fail(start, "wall has no \"begin\"");
+        if(!hasEnd)
+            fail(start, "wall has no \"end\"");
+
+        // walls sit on the level grid
+        if(beginX != std::floor(beginX) || beginZ != std::floor(beginZ) ||
+           endX != std::floor(endX) || endZ != std::floor(endZ))
+            fail(start, "wall coordinates must be whole numbers");
+
+        if(std::fabs(beginX) > LevelParser::MAX_WALL_COORDINATE ||
+           std::fabs(beginZ) > LevelParser::MAX_WALL_COORDINATE ||
+           std::fabs(endX) > LevelParser::MAX_WALL_COORDINATE ||
+           std::fabs(endZ) > LevelParser::MAX_WALL_COORDINATE)
+            fail(start, "wall coordinates out of range");
+
+        m_walls.push_back(WallCoordinates(beginX, beginZ, endX, endZ));
+    }
+
+    // reads a member name and the colon after it; the name is left in
+    // m_key as raw text, escapes and all, since none of the keys we look
+    // for need any
+    void LevelParser::parseKey()
+    {
+        skipWhitespace();
+
+        if(m_position == m_end || *m_position != '"')
+            fail(m_position, "expected a member name");
+
+        const char* start = ++m_position;
+        skipString();
+
+        m_key = start;
+        m_keyLength = m_position - 1 - start;
+
+        expect(':');
+    }
+
+    bool LevelParser::isKey(const char* p_key) const
+    {
+        return std::strlen(p_key) == m_keyLength && std::memcmp(p_key, m_key, m_keyLength) == 0;
+    }
+
+    std::string LevelParser::parseString()
+    {
+        skipWhitespace();
+
+        if(m_position == m_end || *m_position != '"')
+            fail(m_position, "expected a string");
+
+        m_position++;
+
+        std::string result;
+        while(true)
+        {
+            if(m_position == m_end)
+                fail(m_position, "unterminated string");
+
+            char character = *m_position;
+
+            if(character == '"')
+                break;
+
+            if(static_cast<unsigned char>(character) < 0x20)
+                fail(m_position, "control character in string");
+
+            if(character != '\\')
+            {
+                result += character;
+                m_position++;
+                continue;
+            }
+
+            const char* escape = m_position++;
+            if(m_position == m_end)
+                fail(m_position, "unterminated string");
+
+            switch(*m_position++)
+            {
+            case '"': result += '"'; break;
+            case '\\': result += '\\'; break;
+            case '/': result += '/'; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u':
+            {
+                if(m_end - m_position < 4)
+                    fail(escape, "bad unicode escape");
+
+                unsigned int code = 0;
+                for(int i = 0; i < 4; i++)
+                {
+                    char digit = *m_position++;
+                    code <<= 4;
+                    if(digit >= '0' && digit <= '9')
+                        code |= digit - '0';
+                    else if(digit >= 'a' && digit <= 'f')
+                        code |= digit - 'a' + 10;
+                    else if(digit >= 'A' && digit <= 'F')
+                        code |= digit - 'A' + 10;
+                    else
+                        fail(escape, "bad unicode escape");
+                }
+
+                // level names are plain text, surrogate pairs are not
+                // worth supporting
+                if(code >= 0xd800 && code <= 0xdfff)
+                    fail(escape, "surrogate pairs are not supported");
+
+                if(code < 0x80)
+                    result += static_cast<char>(code);
+                else if(code < 0x800)
+                {
+                    result += static_cast<char>(0xc0 | (code >> 6));
+                    result += static_cast<char>(0x80 | (code & 0x3f));
+                }
+                else
+                {
+                    result += static_cast<char>(0xe0 | (code >> 12));
+                    result += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                    result += static_cast<char>(0x80 | (code & 0x3f));
+                }
+                break;
+            }
+            default:
+                fail(escape, "bad escape sequence");
+            }
+        }
+
+        m_position++;
+        return result;
+    }
+
+    // follows the JSON number grammar; the digits are gathered into an
+    // integer and scaled once at the end, which is exact for everything
+    // the level files contain
+    double LevelParser::parseNumber()
+    {
+        skipWhitespace();
+
+        const char* start = m_position;
+        bool negative = consume('-');
+        unsigned long long mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+
+        if(m_position == m_end || *m_position < '0' || *m_position > '9')
+            fail(start, "expected a number");
+
+        if(*m_position == '0')
+            m_position++;
+        else
+        {
+            while(m_position < m_end && *m_position >= '0' && *m_position <= '9')
+            {
+                // digits beyond what fits in the mantissa only scale it
+                if(digits < 19)
+                {
+                    mantissa = mantissa * 10 + (*m_position - '0');
+                    digits++;
+                }
+                else
+                    exponent++;
+                m_position++;
+            }
+        }
+
+        if(m_position < m_end && *m_position == '.')
+        {
+            m_position++;
+            if(m_position == m_end || *m_position < '0' || *m_position > '9')
+                fail(m_position, "expected a digit after the decimal point");
+
+            while(m_position < m_end && *m_position >= '0' && *m_position <= '9')
+            {
+                if(digits < 19)
+                {
+                    mantissa = mantissa * 10 + (*m_position - '0');
+                    if(mantissa != 0)
+                        digits++;
+                    exponent--;
+                }
+                m_position++;
+            }
+        }
+
+        if(m_position < m_end && (*m_position == 'e' || *m_position == 'E'))
+        {
+            m_position++;
+            bool negativeExponent = false;
+            if(m_position < m_end && (*m_position == '+' || *m_position == '-'))
+                negativeExponent = *m_position++ == '-';
+
+            if(m_position == m_end || *m_position < '0' || *m_position > '9')
+                fail(m_position, "expected a digit in the exponent");
+
+            int value = 0;
+            while(m_position < m_end && *m_position >= '0' && *m_position <= '9')
+            {
+                if(value < 10000)
+                    value = value * 10 + (*m_position - '0');
+                m_position++;
+            }
+
+            exponent += negativeExponent ? -value : value;
+        }
+
+        double result = mantissa;
+        if(exponent < 0 && exponent >= -22)
+            result /= POWERS_OF_TEN[-exponent];
+        else if(exponent > 0 && exponent <= 22)
+            result *= POWERS_OF_TEN[exponent];
+        else if(exponent != 0)
+            result *= std::pow(10.0, exponent);
+
+        // every number ends up in a float
+        if(result > std::numeric_limits<float>::max())
+            fail(start, "number out of range");
+
+        return negative ? -result : result;
+    }
+
+    void LevelParser::skipValue(int p_depth)
+    {
+        skipWhitespace();
+
+        if(m_position == m_end)
+            fail(m_position, "expected a value");
+
+        if((*m_position == '{' || *m_position == '[') && p_depth >= LevelParser::MAX_SKIP_DEPTH)
+            fail(m_position, "values nested too deeply");
+
+        switch(*m_position)
+        {
+        case '{':
+            m_position++;
+            if(!consume('}'))
+            {
+                do
+                {
+                    parseKey();
+                    skipValue(p_depth + 1);
+                }
+                while(consume(','));
+
+                expect('}');
+            }
+            break;
+        case '[':
+            m_position++;
+            if(!consume(']'))
+            {
+                do
+                    skipValue(p_depth + 1);
+                while(consume(','));
+
+                expect(']');
+            }
+            break;
+        case '"':
+            m_position++;
+            skipString();
+            break;
+        case 't':
+            skipLiteral("true");
+            break;
+        case 'f':
+            skipLiteral("false");
+            break;
+        case 'n':
+            skipLiteral("null");
+            break;
+        default:
+            parseNumber();
+        }
+    }
+
+    // moves past the closing quote of a string whose opening quote has
+    // already been read
+    void LevelParser::skipString()
+    {
+        while(true)
+        {
+            if(m_position == m_end)
+                fail(m_position, "unterminated string");
+
+            char character = *m_position++;
+
+            if(character == '"')
+                return;
+
+            if(static_cast<unsigned char>(character) < 0x20)
+                fail(m_position - 1, "control character in string");
+
+            if(character == '\\')
+            {
+                if(m_position == m_end)
+                    fail(m_position, "unterminated string");
+                m_position++;
+            }
+        }
+    }
+
+    void LevelParser::skipLiteral(const char* p_literal)
+    {
+        std::size_t length = std::strlen(p_literal);
+
+        if(static_cast<std::size_t>(m_end - m_position) < length ||
+           std::memcmp(m_position, p_literal, length) != 0)
+            fail(m_position, "unexpected character");
+
+        m_position += length;
+    }
+
+    void LevelParser::skipWhitespace()
+    {
+        while(m_position < m_end &&
+              (*m_position == ' ' || *m_position == '\n' || *m_position == '\r' || *m_position == '\t'))
+            m_position++;
+    }
+
+    bool LevelParser::consume(char p_character)
+    {
+        skipWhitespace();
+
+        if(m_position < m_end && *m_position == p_character)
+        {
+            m_position++;
+            return true;
+        }
+
+        return false;
+    }
+
+    void LevelParser::expect(char p_character)
+    {
+        if(!consume(p_character))
+        {
+            std::string message = "expected '";
+            message += p_character;
+            message += "'";
+            fail(m_position, message);
+        }
+    }
+
+    // line and column are only worked out once something has gone wrong,
+    // so keeping track of them costs nothing while parsing
+    void LevelParser::fail(const char* p_position, std::string p_message) const
+    {
+        int line = 1;
+        int column = 1;
+        for(const char* it = m_begin; it < p_position; it++)
+        {
+            if(*it == '\n')
+            {
+                line++;
+                column = 1;
+            }
+            else
+                column++;
+        }
+
+        if(p_position == m_end)
+            p_message += " (at end of file)";
+
+        throw LevelParseError(m_sourceName, line, column, p_message);
+    }
+}
@@ -0,0 +1,224 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LevelPhysics.hpp"
+
+#include <iostream>
+
+namespace TiltBall
+{
+    LevelPhysics::LevelPhysics(PhysicsWorld* p_physicsWorld,
+                               const LevelDescription& p_description,
+                               std::shared_ptr<LevelCollider> p_levelCollider,
+                               TransformMotionState* p_levelMotionState,
+                               TransformMotionState* p_ballMotionState) :
+        m_physicsWorld(p_physicsWorld),
+        m_dynamicsWorld(p_physicsWorld->getDynamicsWorld()),
+        m_levelCollider(p_levelCollider),
+        m_levelBody(0),
+        m_ballBody(0),
+        m_target(0),
+        m_targetPosition(p_description.getTargetX(),
+                         p_description.getTargetY(),
+                         p_description.getTargetZ()),
+        m_ballStartingPosition(p_description.getBallStartingX(),
+                               p_description.getBallStartingY(),
+                               p_description.getBallStartingZ())
+    {
+        buildLevel(p_description, p_levelMotionState);
+        buildBall(p_description, p_ballMotionState);
+    }
+
+    LevelPhysics::~LevelPhysics()
+    {
+        // events may still be waiting about bodies that are about to go
+        m_physicsWorld->getCollisionEvents().clear();
+
+        m_physicsWorld->removeTrigger(m_target);
+        delete m_target;
+
+        btRigidBody* bodies[] = { m_ballBody, m_levelBody };
+
+        for(auto i = 0; i < 2; i++)
+        {
+            m_dynamicsWorld->removeRigidBody(bodies[i]);
+            delete bodies[i]->getMotionState();
+            delete bodies[i];
+        }
+
+        for(auto it = m_collisionShapes.begin(); it < m_collisionShapes.end(); it++)
+            delete (*it);
+
+        m_collisionShapes.clear();
+    }
+
+    void LevelPhysics::buildLevel(const LevelDescription& p_description,
+                                  TransformMotionState* p_levelMotionState)
+    {
+        // bottom surface and walls make up the level; the target is a
+        // trigger the ball can roll into rather than part of the level
+        m_levelBody = attachBodyToPhysicsWorld(p_levelMotionState,
+                                               m_levelCollider->getShape(),
+                                               0,
+                                               0,
+                                               0,
+                                               0,
+                                               PhysicsWorld::BODY_LEVEL);
+
+        // triangle meshes get their contacts along internal edges fixed up
+        if(m_levelCollider->getColliderType() == LevelCollider::COLLIDER_TRIANGLE_MESH)
+            m_levelBody->setCollisionFlags(m_levelBody->getCollisionFlags() |
+                                           btCollisionObject::CF_CUSTOM_MATERIAL_CALLBACK);
+
+        m_target = new btPairCachingGhostObject();
+        m_target->setCollisionShape(buildBoxShape(p_description.buildTargetBox()));
+        m_target->setWorldTransform(btTransform(btQuaternion::getIdentity(), m_targetPosition));
+        m_physicsWorld->addTrigger(m_target, PhysicsWorld::BODY_TARGET);
+    }
+
+    void LevelPhysics::buildBall(const LevelDescription& p_description,
+                                 TransformMotionState* p_ballMotionState)
+    {
+        btCollisionShape* sphereShape = new btSphereShape(btScalar(LevelPhysics::BALL_RADIUS));
+        m_collisionShapes.push_back(sphereShape);
+
+        m_ballBody = attachBodyToPhysicsWorld(p_ballMotionState,
+                                              sphereShape,
+                                              LevelPhysics::BALL_MASS,
+                                              m_ballStartingPosition.x(),
+                                              m_ballStartingPosition.y(),
+                                              m_ballStartingPosition.z(),
+                                              PhysicsWorld::BODY_BALL);
+    }
+
+    btCollisionShape* LevelPhysics::buildBoxShape(const BoxCoordinates& p_box)
+    {
+        btCollisionShape* boxShape =
+            new btBoxShape(btVector3(((p_box.getX2() - p_box.getX1()) / 2),
+                                     ((p_box.getY2() - p_box.getY1()) / 2),
+                                     ((p_box.getZ2() - p_box.getZ1()) / 2)));
+
+        m_collisionShapes.push_back(boxShape);
+
+        return boxShape;
+    }
+
+    btRigidBody* LevelPhysics::attachBodyToPhysicsWorld(TransformMotionState* p_motionState,
+                                                        btCollisionShape* p_collisionShape,
+                                                        float p_mass,
+                                                        float p_originX,
+                                                        float p_originY,
+                                                        float p_originZ,
+                                                        PhysicsWorld::BodyTag p_tag)
+    {
+        btTransform transform;
+        transform.setIdentity();
+        transform.setOrigin(btVector3(p_originX, p_originY, p_originZ));
+
+        btScalar mass(p_mass);
+        btVector3 localInertia(0, 0, 0);
+        if(p_mass > 0)
+            p_collisionShape->calculateLocalInertia(mass, localInertia);
+
+        // the body reads its starting transform from the motion state
+        p_motionState->kinematicSetPosition(transform);
+
+        btRigidBody::btRigidBodyConstructionInfo info(mass,
+                                                      p_motionState,
+                                                      p_collisionShape,
+                                                      localInertia);
+
+        btRigidBody* body = new btRigidBody(info);
+        PhysicsWorld::setBodyTag(body, p_tag);
+
+        body->setRestitution(0);
+        body->setFriction(0.2);
+
+        if(p_mass == 0)
+        {
+            body->setCollisionFlags(body->getCollisionFlags() |
+                                    btCollisionObject::CF_KINEMATIC_OBJECT);
+            body->setActivationState(DISABLE_DEACTIVATION);
+        }
+
+        m_dynamicsWorld->addRigidBody(body);
+
+        return body;
+    }
+
+    void LevelPhysics::setLevelOrientation(const btQuaternion& p_orientation)
+    {
+        TransformMotionState* levelMotionState =
+            static_cast<TransformMotionState*>(m_levelBody->getMotionState());
+        levelMotionState->kinematicSetPosition(btTransform(p_orientation));
+
+        // the target is attached to the level, so it moves along with it;
+        // triggers have no velocity to interpolate, they are simply moved
+        m_target->setWorldTransform(btTransform(p_orientation,
+                                                quatRotate(p_orientation, m_targetPosition)));
+    }
+
+    void LevelPhysics::reset()
+    {
+        placeBody(m_levelBody, btTransform::getIdentity());
+        m_target->setWorldTransform(btTransform(btQuaternion::getIdentity(), m_targetPosition));
+        placeBody(m_ballBody, btTransform(btQuaternion::getIdentity(), m_ballStartingPosition));
+
+        // drop the contact points cached for the ball, they belong to where
+        // it was before
+        m_dynamicsWorld->getBroadphase()->getOverlappingPairCache()->
+            cleanProxyFromPairs(m_ballBody->getBroadphaseHandle(), m_dynamicsWorld->getDispatcher());
+        m_physicsWorld->getCollisionEvents().clear();
+
+        m_ballBody->activate(true);
+    }
+
+    void LevelPhysics::placeBody(btRigidBody* p_body, const btTransform& p_transform)
+    {
+        // kinematic bodies get their velocity from how far their motion
+        // state moved since the last step, so the interpolation transform
+        // has to move too or snapping the level back would fling the ball
+        static_cast<TransformMotionState*>(p_body->getMotionState())->
+            kinematicSetPosition(p_transform);
+        p_body->setWorldTransform(p_transform);
+        p_body->setInterpolationWorldTransform(p_transform);
+
+        p_body->setLinearVelocity(btVector3(0, 0, 0));
+        p_body->setAngularVelocity(btVector3(0, 0, 0));
+        p_body->setInterpolationLinearVelocity(btVector3(0, 0, 0));
+        p_body->setInterpolationAngularVelocity(btVector3(0, 0, 0));
+        p_body->clearForces();
+    }
+
+    btRigidBody* LevelPhysics::getLevelBody()
+    {
+        return m_levelBody;
+    }
+
+    btRigidBody* LevelPhysics::getBallBody()
+    {
+        return m_ballBody;
+    }
+
+    btPairCachingGhostObject* LevelPhysics::getTarget()
+    {
+        return m_target;
+    }
+}
@@ -19,39 +19,121 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "Engine.hpp"
+#include "AssetPack.hpp"
 #include "IntroState.hpp"
 #include "MenuState.hpp"
 #include "RunningState.hpp"
+#include "SynchronizedStreamBuffer.hpp"
+#include "Trace.hpp"
 
+#include <cstdlib>
 #include <fstream>
+#include <stdexcept>
 #include <string>
 
+namespace
+{
+    // the value following a rate option, in updates per second
+    float parseRate(int p_argc, char* p_argv[], int& p_index)
+    {
+        std::string option = p_argv[p_index];
+        if(++p_index >= p_argc)
+            throw std::runtime_error(option + " needs a rate");
+
+        char* end;
+        float rate = std::strtof(p_argv[p_index], &end);
+        if(*end != '\0' || end == p_argv[p_index] || rate < 0)
+            throw std::runtime_error(option + " needs a rate of 0 or more, not " +
+                                     p_argv[p_index]);
+
+        return rate;
+    }
+}
+
 int main(int argc, char *argv[])
 {
     try
     {
         std::ofstream log("tilt_ball.log");
 
-        std::streambuf* old = std::clog.rdbuf(log.rdbuf());
+        // levels are prepared on worker threads, which log as well
+        TiltBall::SynchronizedStreamBuffer logBuffer(log.rdbuf());
 
+        std::streambuf* old = std::clog.rdbuf(&logBuffer);
+
+        // --trace records zones from the start and writes them to
+        // trace.json on exit (and on F4). the rate options override the
+        // engine's defaults, negative means not given
         std::string levelFile;
-        if(argc == 2)
-            levelFile = argv[1];
-        else
-            levelFile = "../resources/levels/level1.json";
+        float inputRate = -1;
+        float simulationRate = -1;
+        float renderRate = -1;
+        bool vsync = true;
+        for(auto i = 1; i < argc; i++)
+        {
+            std::string argument = argv[i];
+            if(argument == "--trace")
+                TiltBall::Trace::setEnabled(true);
+            else if(argument == "--input-rate")
+                inputRate = parseRate(argc, argv, i);
+            else if(argument == "--simulation-rate")
+                simulationRate = parseRate(argc, argv, i);
+            else if(argument == "--render-rate")
+                renderRate = parseRate(argc, argv, i);
+            else if(argument == "--no-vsync")
+                vsync = false;
+            else
+                levelFile = argument;
+        }
+
+        // the build packs the resources into one file, which is mapped
+        // here before anything (audio loading in the background included)
+        // opens a resource
+        if(std::ifstream("../resources/assets.pack").good())
+        {
+            TiltBall::AssetPack::mount("../resources",
+                                       std::make_shared<TiltBall::AssetPack>(
+                                           "../resources/assets.pack"));
+        }
+
+        if(levelFile.empty())
+        {
+            // prefer the compiled levels when they have been built
+            levelFile = "../resources/levels/level1.level";
+            if(!TiltBall::AssetPack::exists(levelFile))
+                levelFile = "../resources/levels/level1.json";
+        }
 
         TiltBall::Engine engine;
+        if(inputRate >= 0)
+            engine.setInputRate(inputRate);
+        if(simulationRate >= 0)
+            engine.setSimulationRate(simulationRate);
+        if(renderRate >= 0)
+            engine.setRenderRate(renderRate);
+        if(!vsync)
+            engine.setVSyncEnabled(false);
+
         engine.pushState(new TiltBall::RunningState(&engine, levelFile));
-        engine.pushState(new TiltBall::MenuState(&engine));
+        TiltBall::MenuState* menu = engine.getMenuState();
+        menu->show();
+        engine.pushState(menu);
         engine.pushState(new TiltBall::IntroState(&engine));
         engine.mainLoop();
 
+        if(TiltBall::Trace::isEnabled())
+            TiltBall::Trace::writeFile("trace.json");
+
         std::clog.rdbuf(old);
     }
     catch(char const* error)
     {
         std::cerr << "UNCAUGHT EXCEPTION: " << error << std::endl;
     }
+    catch(std::exception& error)
+    {
+        std::cerr << "UNCAUGHT EXCEPTION: " << error.what() << std::endl;
+    }
 
     return 0;
 }
@@ -0,0 +1,93 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TiltBall
+{
+    MappedFile::MappedFile(std::string p_fileName) :
+        m_data(0),
+        m_size(0)
+    {
+        int descriptor = open(p_fileName.c_str(), O_RDONLY);
+        if(descriptor < 0)
+            throw std::runtime_error("Could not open " + p_fileName);
+
+        struct stat status;
+        if(fstat(descriptor, &status) < 0)
+        {
+            close(descriptor);
+            throw std::runtime_error("Could not stat " + p_fileName);
+        }
+
+        m_size = status.st_size;
+
+        // mmap refuses empty mappings, an empty file simply has no data
+        if(m_size > 0)
+        {
+            void* data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if(data == MAP_FAILED)
+            {
+                close(descriptor);
+                throw std::runtime_error("Could not map " + p_fileName);
+            }
+
+            m_data = static_cast<const char*>(data);
+        }
+
+        // the mapping stays valid after the descriptor is closed
+        close(descriptor);
+    }
+
+    MappedFile::MappedFile(std::shared_ptr<const MappedFile> p_parent,
+                           std::size_t p_offset,
+                           std::size_t p_size) :
+        m_data(0),
+        m_size(p_size),
+        m_parent(p_parent)
+    {
+        if(p_offset > p_parent->getSize() || p_size > p_parent->getSize() - p_offset)
+            throw std::runtime_error("View outside of the mapped file");
+
+        m_data = p_parent->getData() + p_offset;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if(m_data && !m_parent)
+            munmap(const_cast<char*>(m_data), m_size);
+    }
+
+    const char* MappedFile::getData() const
+    {
+        return m_data;
+    }
+
+    std::size_t MappedFile::getSize() const
+    {
+        return m_size;
+    }
+}
@@ -24,19 +24,17 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 namespace TiltBall
 {
     MenuState::MenuState(Engine* p_engine) :
-        GameState(p_engine)
+        GameState(p_engine),
+        m_sheet(0)
     {
-        std::clog << "Entering menu state..." << std::endl;
+        std::clog << "Building menu..." << std::endl;
 
         CEGUI::WindowManager& windowManager = CEGUI::WindowManager::getSingleton();
 
-        CEGUI::Window* layout = windowManager.loadWindowLayout("main-menu.layout");
-        CEGUI::System::getSingleton().setGUISheet(layout);
-        unsigned int width, height, colorDepth;
-        m_engine->getOgreRoot()->getRenderTarget("main_window")->getMetrics(width,
-                                                                            height,
-                                                                            colorDepth);
-        CEGUI::MouseCursor::getSingleton().show();
+        // built once and kept hidden until the menu is opened
+        m_sheet = windowManager.loadWindowLayout("main-menu.layout");
+        m_sheet->hide();
+        CEGUI::System::getSingleton().setGUISheet(m_sheet);
 
         CEGUI::PushButton* resumeButton =
             (CEGUI::PushButton*)windowManager.getWindow("Menu/Resume");
@@ -53,8 +51,20 @@ namespace TiltBall
         std::clog << "MenuState destructor!" << std::endl;
 
         CEGUI::MouseCursor::getSingleton().hide();
-        CEGUI::System::getSingleton().getGUISheet()->hide();
-        CEGUI::WindowManager::getSingleton().destroyAllWindows();
+        CEGUI::System::getSingleton().setGUISheet(0);
+        CEGUI::WindowManager::getSingleton().destroyWindow(m_sheet);
+    }
+
+    void MenuState::show()
+    {
+        m_sheet->show();
+        CEGUI::MouseCursor::getSingleton().show();
+    }
+
+    void MenuState::hide()
+    {
+        CEGUI::MouseCursor::getSingleton().hide();
+        m_sheet->hide();
     }
 
     void MenuState::pause()
@@ -65,32 +75,49 @@ namespace TiltBall
     {
     }
 
+    bool MenuState::needsContinuousRendering() const
+    {
+        return false;
+    }
+
     bool MenuState::update(const Ogre::FrameEvent& p_event)
     {
         InputSystem* inputSystem = m_engine->getInputSystem();
-        inputSystem->capture();
+        {
+            FrameProfiler::Scope scope(m_engine->getProfiler(), FrameProfiler::SECTION_INPUT);
+            inputSystem->capture();
+        }
 
         return true;
     }
 
+    void MenuState::simulate(float p_elapsed)
+    {
+    }
+
     bool MenuState::mouseMoved(const OIS::MouseEvent& p_evt)
     {
         CEGUI::System::getSingleton().injectMouseMove(p_evt.state.X.rel, p_evt.state.Y.rel);
         if (p_evt.state.Z.rel)
             CEGUI::System::getSingleton().injectMouseWheelChange(p_evt.state.Z.rel / 120.0f);
 
+        // at least the cursor moved
+        m_engine->requestRedraw();
+
         return true;
     }
 
     bool MenuState::mousePressed(const OIS::MouseEvent& p_evt, OIS::MouseButtonID p_buttonId)
     {
         CEGUI::System::getSingleton().injectMouseButtonDown(convertMouseButton(p_buttonId));
+        m_engine->requestRedraw();
         return true;
     }
 
     bool MenuState::mouseReleased(const OIS::MouseEvent& p_evt, OIS::MouseButtonID p_buttonId)
     {
         CEGUI::System::getSingleton().injectMouseButtonUp(convertMouseButton(p_buttonId));
+        m_engine->requestRedraw();
         return true;
     }
 
@@ -98,9 +125,13 @@ namespace TiltBall
     {
          CEGUI::System::getSingleton().injectKeyDown(p_evt.key);
          CEGUI::System::getSingleton().injectChar(p_evt.text);
+         m_engine->requestRedraw();
 
          if (p_evt.key == OIS::KC_ESCAPE)
+         {
+             hide();
              m_engine->requestPop();
+         }
 
         return true;
     }
@@ -132,6 +163,7 @@ namespace TiltBall
     {
         std::clog << "Resume clicked!" << std::endl;
         m_engine->getAudioSystem()->playClickSound();
+        hide();
         m_engine->requestPop();
         return true;
     }
@@ -0,0 +1,209 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MusicStream.hpp"
+#include "AssetPack.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace TiltBall
+{
+    MusicStream::MusicStream(std::string p_fileName, float p_gain) :
+        m_file(AssetPack::openFile(p_fileName)),
+        m_filePosition(0),
+        m_pcm(MusicStream::BUFFER_SIZE),
+        m_stopping(false)
+    {
+        ov_callbacks callbacks;
+        callbacks.read_func = &MusicStream::read;
+        callbacks.seek_func = &MusicStream::seek;
+        callbacks.close_func = 0;
+        callbacks.tell_func = &MusicStream::tell;
+
+        if(ov_open_callbacks(this, &m_vorbis, 0, 0, callbacks) != 0)
+            throw std::runtime_error("Could not open music file " + p_fileName);
+
+        vorbis_info* info = ov_info(&m_vorbis, -1);
+        m_format = info->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+        m_rate = info->rate;
+
+        alGenBuffers(MusicStream::BUFFER_COUNT, m_buffers);
+        alGenSources(1, &m_source);
+        alSourcef(m_source, AL_GAIN, p_gain);
+
+        // the first few buffers are decoded here so the music starts at
+        // once, the thread keeps it going from there
+        for(auto i = 0; i < MusicStream::BUFFER_COUNT; i++)
+        {
+            if(!fillBuffer(m_buffers[i]))
+                break;
+
+            alSourceQueueBuffers(m_source, 1, &m_buffers[i]);
+        }
+
+        alSourcePlay(m_source);
+
+        m_thread = std::thread(&MusicStream::stream, this);
+    }
+
+    MusicStream::~MusicStream()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeUp.notify_one();
+        m_thread.join();
+
+        alSourceStop(m_source);
+        alSourcei(m_source, AL_BUFFER, 0);
+        alDeleteSources(1, &m_source);
+        alDeleteBuffers(MusicStream::BUFFER_COUNT, m_buffers);
+
+        ov_clear(&m_vorbis);
+    }
+
+    void MusicStream::stream()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        bool endOfFile = false;
+        while(!m_stopping && !endOfFile)
+        {
+            ALint processed = 0;
+            alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
+
+            if(processed > 0)
+            {
+                TraceZone zone("MusicStream::stream");
+
+                for(auto i = 0; i < processed && !endOfFile; i++)
+                {
+                    ALuint buffer;
+                    alSourceUnqueueBuffers(m_source, 1, &buffer);
+
+                    if(fillBuffer(buffer))
+                        alSourceQueueBuffers(m_source, 1, &buffer);
+                    else
+                        endOfFile = true;
+                }
+            }
+
+            // if we fell behind, the source stopped once it ran out of
+            // buffers and has to be started again
+            ALint state;
+            alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+            if(state != AL_PLAYING)
+            {
+                std::clog << "Music ran out of decoded data, restarting it" << std::endl;
+                alSourcePlay(m_source);
+            }
+
+            m_wakeUp.wait_for(lock, std::chrono::milliseconds(MusicStream::POLL_MILLISECONDS));
+        }
+
+        // whatever is still queued plays out on its own
+    }
+
+    bool MusicStream::fillBuffer(ALuint p_buffer)
+    {
+        int bitstream;
+        int filled = 0;
+
+        while(filled < MusicStream::BUFFER_SIZE)
+        {
+            long bytesRead = ov_read(&m_vorbis,
+                                     &m_pcm[filled],
+                                     MusicStream::BUFFER_SIZE - filled,
+                                     0,
+                                     2,
+                                     1,
+                                     &bitstream);
+            if(bytesRead <= 0)
+                break;
+
+            filled += bytesRead;
+        }
+
+        if(filled == 0)
+            return false;
+
+        alBufferData(p_buffer, m_format, &m_pcm[0], filled, m_rate);
+
+        return true;
+    }
+
+    size_t MusicStream::read(void* p_destination, size_t p_size, size_t p_count, void* p_stream)
+    {
+        MusicStream* stream = static_cast<MusicStream*>(p_stream);
+
+        if(p_size == 0)
+            return 0;
+
+        size_t count = std::min(p_count,
+                                (stream->m_file->getSize() - stream->m_filePosition) / p_size);
+        std::memcpy(p_destination, stream->m_file->getData() + stream->m_filePosition,
+                    count * p_size);
+        stream->m_filePosition += count * p_size;
+
+        return count;
+    }
+
+    int MusicStream::seek(void* p_stream, ogg_int64_t p_offset, int p_whence)
+    {
+        MusicStream* stream = static_cast<MusicStream*>(p_stream);
+
+        ogg_int64_t position;
+        switch(p_whence)
+        {
+        case SEEK_SET:
+            position = p_offset;
+            break;
+
+        case SEEK_CUR:
+            position = stream->m_filePosition + p_offset;
+            break;
+
+        case SEEK_END:
+            position = stream->m_file->getSize() + p_offset;
+            break;
+
+        default:
+            return -1;
+        }
+
+        if(position < 0 || position > (ogg_int64_t)stream->m_file->getSize())
+            return -1;
+
+        stream->m_filePosition = position;
+        return 0;
+    }
+
+    long MusicStream::tell(void* p_stream)
+    {
+        return static_cast<MusicStream*>(p_stream)->m_filePosition;
+    }
+}
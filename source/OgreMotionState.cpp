@@ -22,11 +22,9 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace TiltBall
 {
-    OgreMotionState::OgreMotionState(btTransform& p_initialpos,
-                                     Ogre::SceneNode* p_node)
+    OgreMotionState::OgreMotionState(Ogre::SceneNode* p_node)
     {
         m_node = p_node;
-        m_position = p_initialpos;
     }
 
     void OgreMotionState::setNode(Ogre::SceneNode* p_node)
@@ -34,22 +32,13 @@ namespace TiltBall
         m_node = p_node;
     }
 
-    void OgreMotionState::getWorldTransform(btTransform& p_worldTrans) const
-    {
-        p_worldTrans = m_position;
-    }
-
-    void OgreMotionState::setWorldTransform(const btTransform& p_worldTrans)
+    void OgreMotionState::interpolate(btScalar p_alpha)
     {
         if(NULL == m_node) return; // silently return before we set a node
-        btQuaternion rot = p_worldTrans.getRotation();
+        btTransform transform = getInterpolatedTransform(p_alpha);
+        btQuaternion rot = transform.getRotation();
         m_node->setOrientation(rot.w(), rot.x(), rot.y(), rot.z());
-        btVector3 pos = p_worldTrans.getOrigin();
+        btVector3 pos = transform.getOrigin();
         m_node->setPosition(pos.x(), pos.y(), pos.z());
     }
-
-    void OgreMotionState::kinematicSetPosition(btTransform& p_worldTrans)
-    {
-        m_position = p_worldTrans;
-    }
 }
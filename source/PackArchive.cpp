@@ -0,0 +1,197 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "PackArchive.hpp"
+
+namespace TiltBall
+{
+    // a stream over a file in the pack that keeps the pack mapped for as
+    // long as Ogre or CEGUI hold on to it
+    class PackDataStream : public Ogre::MemoryDataStream
+    {
+    public:
+        PackDataStream(const Ogre::String& p_name, std::shared_ptr<MappedFile> p_file) :
+            Ogre::MemoryDataStream(p_name,
+                                   const_cast<char*>(p_file->getData()),
+                                   p_file->getSize(),
+                                   false,
+                                   true),
+            m_file(p_file)
+        {
+        }
+
+    private:
+        std::shared_ptr<MappedFile> m_file;
+    };
+
+    const Ogre::String PackArchiveFactory::TYPE = "TiltBallPack";
+
+    PackArchive::PackArchive(const Ogre::String& p_name,
+                             const Ogre::String& p_type,
+                             std::shared_ptr<AssetPack> p_pack,
+                             std::string p_group) :
+        Ogre::Archive(p_name, p_type),
+        m_pack(p_pack),
+        m_group(p_group)
+    {
+    }
+
+    bool PackArchive::isCaseSensitive() const
+    {
+        return true;
+    }
+
+    void PackArchive::load()
+    {
+        m_paths.clear();
+
+        std::vector<std::string> paths = m_pack->getPaths(m_group);
+        for(auto it = paths.begin(); it < paths.end(); it++)
+        {
+            std::string::size_type slash = it->rfind('/');
+            m_paths[slash == std::string::npos ? *it : it->substr(slash + 1)] = *it;
+        }
+    }
+
+    void PackArchive::unload()
+    {
+        m_paths.clear();
+    }
+
+    Ogre::DataStreamPtr PackArchive::open(const Ogre::String& p_fileName, bool p_readOnly) const
+    {
+        std::string path = findPath(p_fileName);
+        if(path.empty())
+        {
+            OGRE_EXCEPT(Ogre::Exception::ERR_FILE_NOT_FOUND,
+                        "No " + p_fileName + " in " + mName,
+                        "PackArchive::open");
+        }
+
+        return Ogre::DataStreamPtr(OGRE_NEW PackDataStream(p_fileName, m_pack->open(path)));
+    }
+
+    Ogre::StringVectorPtr PackArchive::list(bool p_recursive, bool p_dirs)
+    {
+        return find("*", p_recursive, p_dirs);
+    }
+
+    Ogre::FileInfoListPtr PackArchive::listFileInfo(bool p_recursive, bool p_dirs)
+    {
+        return findFileInfo("*", p_recursive, p_dirs);
+    }
+
+    Ogre::StringVectorPtr PackArchive::find(const Ogre::String& p_pattern,
+                                            bool p_recursive,
+                                            bool p_dirs)
+    {
+        Ogre::StringVectorPtr names(OGRE_NEW_T(Ogre::StringVector, Ogre::MEMCATEGORY_GENERAL)(),
+                                    Ogre::SPFM_DELETE_T);
+
+        // there are no directories in a group
+        if(p_dirs)
+            return names;
+
+        for(auto it = m_paths.begin(); it != m_paths.end(); it++)
+        {
+            if(Ogre::StringUtil::match(it->first, p_pattern, true))
+                names->push_back(it->first);
+        }
+
+        return names;
+    }
+
+    Ogre::FileInfoListPtr PackArchive::findFileInfo(const Ogre::String& p_pattern,
+                                                    bool p_recursive,
+                                                    bool p_dirs) const
+    {
+        Ogre::FileInfoListPtr infos(OGRE_NEW_T(Ogre::FileInfoList, Ogre::MEMCATEGORY_GENERAL)(),
+                                    Ogre::SPFM_DELETE_T);
+
+        if(p_dirs)
+            return infos;
+
+        for(auto it = m_paths.begin(); it != m_paths.end(); it++)
+        {
+            if(!Ogre::StringUtil::match(it->first, p_pattern, true))
+                continue;
+
+            std::shared_ptr<MappedFile> file = m_pack->open(it->second);
+
+            Ogre::FileInfo info;
+            info.archive = this;
+            info.filename = it->first;
+            info.basename = it->first;
+            info.path = "";
+            info.compressedSize = file->getSize();
+            info.uncompressedSize = file->getSize();
+            infos->push_back(info);
+        }
+
+        return infos;
+    }
+
+    bool PackArchive::exists(const Ogre::String& p_fileName)
+    {
+        return !findPath(p_fileName).empty();
+    }
+
+    time_t PackArchive::getModifiedTime(const Ogre::String& p_fileName)
+    {
+        // the pack is rebuilt as a whole, nothing in it changes on its own
+        return 0;
+    }
+
+    std::string PackArchive::findPath(const Ogre::String& p_fileName) const
+    {
+        auto it = m_paths.find(p_fileName);
+        if(it == m_paths.end())
+            return std::string();
+
+        return it->second;
+    }
+
+    PackArchiveFactory::PackArchiveFactory(std::shared_ptr<AssetPack> p_pack) :
+        m_pack(p_pack)
+    {
+    }
+
+    const Ogre::String& PackArchiveFactory::getType() const
+    {
+        return PackArchiveFactory::TYPE;
+    }
+
+    Ogre::Archive* PackArchiveFactory::createInstance(const Ogre::String& p_name)
+    {
+        std::string::size_type at = p_name.find('@');
+        if(at == std::string::npos)
+        {
+            OGRE_EXCEPT(Ogre::Exception::ERR_INVALIDPARAMS,
+                        "Expected <group>@<pack file>, got " + p_name,
+                        "PackArchiveFactory::createInstance");
+        }
+
+        return OGRE_NEW PackArchive(p_name, PackArchiveFactory::TYPE, m_pack, p_name.substr(0, at));
+    }
+
+    void PackArchiveFactory::destroyInstance(Ogre::Archive* p_archive)
+    {
+        OGRE_DELETE p_archive;
+    }
+}
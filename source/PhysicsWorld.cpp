@@ -0,0 +1,314 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PhysicsWorld.hpp"
+#include "Trace.hpp"
+#include "TransformMotionState.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
+
+namespace TiltBall
+{
+    // a ball rolling over a triangle mesh bumps into the edges between
+    // neighbouring triangles of the same flat surface; Bullet corrects
+    // those contact normals here, for bodies that ask for it
+    static bool adjustInternalEdgeContacts(btManifoldPoint& p_point,
+                                           const btCollisionObjectWrapper* p_object0,
+                                           int p_partId0,
+                                           int p_index0,
+                                           const btCollisionObjectWrapper* p_object1,
+                                           int p_partId1,
+                                           int p_index1)
+    {
+        btAdjustInternalEdgeContacts(p_point, p_object1, p_object0, p_partId1, p_index1);
+        return true;
+    }
+
+    PhysicsWorld::PhysicsWorld() :
+        m_collisionConfiguration(new btDefaultCollisionConfiguration()),
+        m_dispatcher(new btCollisionDispatcher(m_collisionConfiguration)),
+        m_broadphase(new btDbvtBroadphase()),
+        m_solver(new btSequentialImpulseConstraintSolver()),
+        m_dynamicsWorld(new btDiscreteDynamicsWorld(m_dispatcher,
+                                                    m_broadphase,
+                                                    m_solver,
+                                                    m_collisionConfiguration)),
+        m_ghostPairCallback(new btGhostPairCallback()),
+        m_fixedTimeStep(1 / PhysicsWorld::DEFAULT_STEP_RATE),
+        m_maxSubSteps(PhysicsWorld::DEFAULT_MAX_SUB_STEPS),
+        m_accumulator(0),
+        m_frozen(false),
+        m_profiler(0)
+    {
+        m_dynamicsWorld->setGravity(btVector3(0, PhysicsWorld::GRAVITY, 0));
+        m_dynamicsWorld->setInternalTickCallback(PhysicsWorld::tickCallback, this);
+
+        // a global in Bullet; set once here on the main thread rather than by
+        // each level collider, which is built on a worker thread
+        gContactAddedCallback = adjustInternalEdgeContacts;
+
+        // keeps the pair caches of the triggers up to date
+        m_broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(m_ghostPairCallback);
+    }
+
+    PhysicsWorld::~PhysicsWorld()
+    {
+        delete m_dynamicsWorld;
+        delete m_ghostPairCallback;
+        delete m_solver;
+        delete m_broadphase;
+        delete m_dispatcher;
+        delete m_collisionConfiguration;
+    }
+
+    btDiscreteDynamicsWorld* PhysicsWorld::getDynamicsWorld()
+    {
+        return m_dynamicsWorld;
+    }
+
+    void PhysicsWorld::step(float p_elapsed)
+    {
+        if(m_frozen)
+            return;
+
+        // nobody handled these in time, they are stale now
+        m_collisionEvents.clear();
+
+        m_accumulator += p_elapsed;
+
+        int subSteps = 0;
+        while(m_accumulator >= m_fixedTimeStep && subSteps < m_maxSubSteps)
+        {
+            {
+                FrameProfiler::Scope scope(m_profiler, FrameProfiler::SECTION_MOTION_STATES);
+                savePreviousPositions();
+            }
+
+            // exactly one step of exactly m_fixedTimeStep, bullet then hands
+            // the motion states the actual (not extrapolated) transforms
+            {
+                FrameProfiler::Scope scope(m_profiler, FrameProfiler::SECTION_PHYSICS_STEP);
+                m_dynamicsWorld->stepSimulation(m_fixedTimeStep, 1, m_fixedTimeStep);
+            }
+
+            m_accumulator -= m_fixedTimeStep;
+            subSteps++;
+        }
+
+        // if we could not keep up, let the simulation fall behind instead of
+        // trying to catch up with ever more steps
+        if(m_accumulator >= m_fixedTimeStep)
+            m_accumulator = std::fmod(m_accumulator, m_fixedTimeStep);
+
+        FrameProfiler::Scope scope(m_profiler, FrameProfiler::SECTION_MOTION_STATES);
+        interpolateMotionStates(m_accumulator / m_fixedTimeStep);
+    }
+
+    void PhysicsWorld::savePreviousPositions()
+    {
+        btCollisionObjectArray& objects = m_dynamicsWorld->getCollisionObjectArray();
+
+        for(auto i = 0; i < objects.size(); i++)
+        {
+            btRigidBody* body = btRigidBody::upcast(objects[i]);
+            if(!body || body->isStaticOrKinematicObject())
+                continue;
+
+            TransformMotionState* motionState =
+                dynamic_cast<TransformMotionState*>(body->getMotionState());
+            if(motionState)
+                motionState->savePreviousPosition();
+        }
+    }
+
+    void PhysicsWorld::interpolateMotionStates(btScalar p_alpha)
+    {
+        btCollisionObjectArray& objects = m_dynamicsWorld->getCollisionObjectArray();
+
+        for(auto i = 0; i < objects.size(); i++)
+        {
+            btRigidBody* body = btRigidBody::upcast(objects[i]);
+            if(!body || body->isStaticOrKinematicObject())
+                continue;
+
+            TransformMotionState* motionState =
+                dynamic_cast<TransformMotionState*>(body->getMotionState());
+            if(motionState)
+                motionState->interpolate(p_alpha);
+        }
+    }
+
+    void PhysicsWorld::setFrozen(bool p_frozen)
+    {
+        m_frozen = p_frozen;
+    }
+
+    bool PhysicsWorld::isFrozen() const
+    {
+        return m_frozen;
+    }
+
+    float PhysicsWorld::getFixedTimeStep() const
+    {
+        return m_fixedTimeStep;
+    }
+
+    void PhysicsWorld::setProfiler(FrameProfiler* p_profiler)
+    {
+        m_profiler = p_profiler;
+    }
+
+    CollisionEventQueue& PhysicsWorld::getCollisionEvents()
+    {
+        return m_collisionEvents;
+    }
+
+    void PhysicsWorld::tickCallback(btDynamicsWorld* p_world, btScalar p_timeStep)
+    {
+        TraceZone zone("PhysicsWorld::tickCallback");
+
+        static_cast<PhysicsWorld*>(p_world->getWorldUserInfo())->recordCollisionEvents();
+    }
+
+    void PhysicsWorld::addTrigger(btPairCachingGhostObject* p_trigger, BodyTag p_tag)
+    {
+        setBodyTag(p_trigger, p_tag);
+        p_trigger->setCollisionFlags(p_trigger->getCollisionFlags() |
+                                     btCollisionObject::CF_NO_CONTACT_RESPONSE);
+
+        // the level and other kinematic bodies are static as far as the
+        // broadphase is concerned, so they never pair up with the trigger
+        m_dynamicsWorld->addCollisionObject(p_trigger,
+                                            btBroadphaseProxy::SensorTrigger,
+                                            btBroadphaseProxy::DefaultFilter);
+        m_triggers.push_back(p_trigger);
+    }
+
+    void PhysicsWorld::removeTrigger(btPairCachingGhostObject* p_trigger)
+    {
+        m_dynamicsWorld->removeCollisionObject(p_trigger);
+        m_triggers.erase(std::remove(m_triggers.begin(), m_triggers.end(), p_trigger),
+                         m_triggers.end());
+    }
+
+    void PhysicsWorld::setBodyTag(btCollisionObject* p_body, BodyTag p_tag)
+    {
+        p_body->setUserIndex(p_tag);
+    }
+
+    PhysicsWorld::BodyTag PhysicsWorld::getBodyTag(const btCollisionObject* p_body)
+    {
+        return static_cast<BodyTag>(p_body->getUserIndex());
+    }
+
+    void PhysicsWorld::recordCollisionEvents()
+    {
+        btDispatcher* dispatcher = m_dynamicsWorld->getDispatcher();
+        int numManifolds = dispatcher->getNumManifolds();
+
+        for(auto i = 0; i < numManifolds; i++)
+        {
+            btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+
+            if(manifold->getNumContacts() == 0)
+                continue;
+
+            // triggers are looked at below, through their own pairs
+            if(getBodyTag(manifold->getBody0()) == BODY_BALL &&
+               getBodyTag(manifold->getBody1()) == BODY_LEVEL)
+                recordWallImpact(manifold, manifold->getBody1());
+            else if(getBodyTag(manifold->getBody1()) == BODY_BALL &&
+                    getBodyTag(manifold->getBody0()) == BODY_LEVEL)
+                recordWallImpact(manifold, manifold->getBody0());
+        }
+
+        for(auto it = m_triggers.begin(); it < m_triggers.end(); it++)
+        {
+            if(!isTriggerTouched(*it))
+                continue;
+
+            switch(getBodyTag(*it))
+            {
+            case BODY_TARGET:
+                m_collisionEvents.push(CollisionEvent::EVENT_TARGET_REACHED, 0);
+                break;
+
+            case BODY_HAZARD:
+                m_collisionEvents.push(CollisionEvent::EVENT_HAZARD_HIT, 0);
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    void PhysicsWorld::recordWallImpact(btPersistentManifold* p_manifold,
+                                        const btCollisionObject* p_levelBody)
+    {
+        btVector3 levelUp = p_levelBody->getWorldTransform().getBasis().getColumn(1);
+
+        // a contact made during this very step is the ball hitting a wall,
+        // older ones are it rolling along. collision detection ages every
+        // point of a manifold once per step (refreshContactPoints), new ones
+        // included, so by the time the tick callback runs a new point has a
+        // lifetime of 1, or 0 if its algorithm does not refresh
+        btScalar impulse = 0;
+        for(auto i = 0; i < p_manifold->getNumContacts(); i++)
+        {
+            const btManifoldPoint& point = p_manifold->getContactPoint(i);
+
+            if(point.getLifeTime() <= 1 &&
+               btFabs(point.m_normalWorldOnB.dot(levelUp)) < PhysicsWorld::WALL_NORMAL_LIMIT)
+                impulse = btMax(impulse, point.getAppliedImpulse());
+        }
+
+        if(impulse > 0)
+            m_collisionEvents.push(CollisionEvent::EVENT_WALL_IMPACT, impulse);
+    }
+
+    bool PhysicsWorld::isTriggerTouched(btPairCachingGhostObject* p_trigger)
+    {
+        btBroadphasePairArray& pairs = p_trigger->getOverlappingPairCache()->getOverlappingPairArray();
+
+        for(auto i = 0; i < pairs.size(); i++)
+        {
+            // the trigger only knows that the bounding boxes overlap, the
+            // contacts are in the world's pair
+            btBroadphasePair* pair =
+                m_dynamicsWorld->getPairCache()->findPair(pairs[i].m_pProxy0, pairs[i].m_pProxy1);
+            if(!pair || !pair->m_algorithm)
+                continue;
+
+            m_triggerManifolds.resize(0);
+            pair->m_algorithm->getAllContactManifolds(m_triggerManifolds);
+
+            for(auto j = 0; j < m_triggerManifolds.size(); j++)
+            {
+                if(m_triggerManifolds[j]->getNumContacts() > 0)
+                    return true;
+            }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,100 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PreparedLevel.hpp"
+#include "Trace.hpp"
+
+#include <iostream>
+#include <vector>
+
+namespace TiltBall
+{
+    PreparedLevel::PreparedLevel(std::string p_fileName,
+                                 LevelCollider::ColliderType p_colliderType,
+                                 ColliderCache* p_colliderCache,
+                                 bool p_wallGeometry) :
+        m_fileName(p_fileName),
+        m_wallGeometry(p_wallGeometry)
+    {
+        TraceZone zone("PreparedLevel::PreparedLevel");
+
+        m_description.load(p_fileName);
+
+        std::clog << "Creating bottom surface..." << std::endl;
+        std::vector<BoxCoordinates> bottomSurfaceBoxes = m_description.buildBottomSurfaceBoxes();
+        for(auto it = bottomSurfaceBoxes.begin(); it < bottomSurfaceBoxes.end(); it++)
+            m_bottomSurface.addBox(*it);
+        m_bottomSurface.build();
+
+        std::clog << "Creating walls..." << std::endl;
+        m_wallBoxes = m_description.buildWallBoxes();
+        if(m_wallGeometry)
+        {
+            for(auto it = m_wallBoxes.begin(); it < m_wallBoxes.end(); it++)
+                m_walls.addBox(*it);
+            m_walls.build();
+        }
+
+        m_target.addBox(m_description.buildTargetBox());
+        m_target.build();
+
+        m_collider = p_colliderCache->getCollider(m_description, p_colliderType);
+    }
+
+    std::string PreparedLevel::getFileName() const
+    {
+        return m_fileName;
+    }
+
+    const LevelDescription& PreparedLevel::getDescription() const
+    {
+        return m_description;
+    }
+
+    const LevelGeometry& PreparedLevel::getBottomSurface() const
+    {
+        return m_bottomSurface;
+    }
+
+    bool PreparedLevel::hasWallGeometry() const
+    {
+        return m_wallGeometry;
+    }
+
+    const LevelGeometry& PreparedLevel::getWalls() const
+    {
+        return m_walls;
+    }
+
+    const std::vector<BoxCoordinates>& PreparedLevel::getWallBoxes() const
+    {
+        return m_wallBoxes;
+    }
+
+    const LevelGeometry& PreparedLevel::getTarget() const
+    {
+        return m_target;
+    }
+
+    std::shared_ptr<LevelCollider> PreparedLevel::getCollider() const
+    {
+        return m_collider;
+    }
+}
@@ -0,0 +1,104 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ProfilerOverlay.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace TiltBall
+{
+    ProfilerOverlay::ProfilerOverlay(FrameProfiler* p_profiler) :
+        m_profiler(p_profiler),
+        m_overlay(Ogre::OverlayManager::getSingleton().getByName("Overlays/Profiler")),
+        m_framesUntilRefresh(0)
+    {
+        const char* names[] = { "ProfilerSections", "ProfilerP50", "ProfilerP95", "ProfilerP99" };
+
+        for(auto i = 0; i < 4; i++)
+            m_columns[i] = Ogre::OverlayManager::getSingleton().getOverlayElement(names[i]);
+    }
+
+    void ProfilerOverlay::toggle()
+    {
+        if(m_overlay->isVisible())
+        {
+            m_overlay->hide();
+        }
+        else
+        {
+            refresh();
+            m_overlay->show();
+        }
+    }
+
+    void ProfilerOverlay::update()
+    {
+        if(!m_overlay->isVisible())
+            return;
+
+        m_framesUntilRefresh--;
+        if(m_framesUntilRefresh <= 0)
+            refresh();
+    }
+
+    void ProfilerOverlay::refresh()
+    {
+        m_framesUntilRefresh = ProfilerOverlay::REFRESH_FRAMES;
+
+        std::ostringstream columns[4];
+        columns[0] << m_profiler->getFrameCount() << " frames, ms\n";
+        columns[1] << "p50\n";
+        columns[2] << "p95\n";
+        columns[3] << "p99\n";
+
+        for(auto i = 0; i < FrameProfiler::SECTION_COUNT; i++)
+        {
+            FrameProfiler::Section section = static_cast<FrameProfiler::Section>(i);
+            FrameProfiler::Percentiles percentiles = m_profiler->getPercentiles(section);
+
+            // sections that do not run before every frame (input
+            // capture) say how many frames their percentiles are over
+            columns[0] << FrameProfiler::getSectionName(section);
+            int samples = m_profiler->getSampleCount(section);
+            if(samples != m_profiler->getFrameCount())
+                columns[0] << " (" << samples << ")";
+            columns[0] << "\n";
+            columns[1] << std::fixed << std::setprecision(2) << percentiles.m_p50 << "\n";
+            columns[2] << std::fixed << std::setprecision(2) << percentiles.m_p95 << "\n";
+            columns[3] << std::fixed << std::setprecision(2) << percentiles.m_p99 << "\n";
+        }
+
+        for(auto i = 0; i < 4; i++)
+            m_columns[i]->setCaption(columns[i].str());
+    }
+
+    void ProfilerOverlay::dump(std::string p_baseName)
+    {
+        std::clog << "Writing frame timings to " << p_baseName << ".csv and .json..." << std::endl;
+
+        std::ofstream csv((p_baseName + ".csv").c_str());
+        m_profiler->writeCsv(csv);
+
+        std::ofstream json((p_baseName + ".json").c_str());
+        m_profiler->writeJson(json);
+    }
+}
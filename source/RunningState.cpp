@@ -19,15 +19,24 @@ along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "RunningState.hpp"
+#include "AssetPack.hpp"
+#include "AudioSystem.hpp"
 #include "MenuState.hpp"
 #include "Level.hpp"
-#include "OgreMotionState.hpp"
+#include "Trace.hpp"
+
 
 namespace TiltBall
 {
     RunningState::RunningState(Engine* p_engine, std::string p_levelFile) :
         GameState(p_engine),
-        m_currentLevel(new Level(p_engine, p_levelFile))
+        m_currentLevel(new Level(p_engine,
+                                 std::make_shared<PreparedLevel>(
+                                     p_levelFile,
+                                     LevelCollider::COLLIDER_TRIANGLE_MESH,
+                                     p_engine->getColliderCache(),
+                                     !Level::supportsInstancedWalls(p_engine)))),
+        m_levelCompleted(false)
     {
         std::clog << "Entering running state..." << std::endl;
         Ogre::SceneManager* sceneManager = m_engine->getOgreRoot()->
@@ -35,6 +44,8 @@ namespace TiltBall
 
         std::clog << "Setting up lighting..." << std::endl;
         sceneManager->setAmbientLight(Ogre::ColourValue(0.7, 0.7, 0.7));
+
+        startPreloading();
     }
 
     RunningState::~RunningState()
@@ -44,25 +55,43 @@ namespace TiltBall
 
     void RunningState::pause()
     {
+        m_engine->getPhysicsWorld()->setFrozen(true);
     }
 
     void RunningState::resume()
     {
+        m_engine->getPhysicsWorld()->setFrozen(false);
+    }
+
+    GameState::PausedRendering RunningState::getPausedRendering() const
+    {
+        return PAUSED_RENDER_FROZEN;
     }
 
     bool RunningState::update(const Ogre::FrameEvent& p_event)
     {
-        m_engine->getDynamicsWorld()->stepSimulation(m_engine->getTimeSinceLastFrame());
+        TraceZone zone("RunningState::update");
 
         InputSystem* inputSystem = m_engine->getInputSystem();
-        inputSystem->capture();
+        {
+            FrameProfiler::Scope scope(m_engine->getProfiler(), FrameProfiler::SECTION_INPUT);
+            inputSystem->capture();
+        }
+
+        if(m_levelCompleted)
+            loadNextLevel();
+
+        {
+            FrameProfiler::Scope scope(m_engine->getProfiler(), FrameProfiler::SECTION_DEBUG_DRAW);
 
-        m_engine->getDebugDrawer()->clear();
-        if(inputSystem->isKeyDown(OIS::KC_F1))
-            m_engine->getDynamicsWorld()->debugDrawWorld();
+            BulletDebugDrawer* debugDrawer = m_engine->getDebugDrawer();
+            debugDrawer->clear();
+            if(inputSystem->isKeyDown(OIS::KC_F1))
+                m_engine->getDynamicsWorld()->debugDrawWorld();
+            debugDrawer->update();
+        }
 
         Ogre::SceneNode* levelNode = m_currentLevel->getLevelNode();
-        Ogre::SceneNode* targetNode = m_currentLevel->getTargetNode();
         Ogre::SceneNode* ballNode = m_currentLevel->getBallNode();
 
         const OIS::MouseState& mouseState = inputSystem->getMouseState();
@@ -71,44 +100,59 @@ namespace TiltBall
         levelNode->roll(Ogre::Degree(-(float)mouseState.X.rel / 20), Ogre::Node::TS_LOCAL);
         levelNode->pitch(Ogre::Degree((float)mouseState.Y.rel / 20), Ogre::Node::TS_WORLD);
 
-        btRigidBody* levelBody = m_currentLevel->getLevelBody();
-        OgreMotionState* levelMotionState =
-            dynamic_cast<OgreMotionState*>(levelBody->getMotionState());
-
-        btTransform newBtLevelTransform = btTransform(btQuaternion(levelNode->getOrientation().x,
-                                                                   levelNode->getOrientation().y,
-                                                                   levelNode->getOrientation().z,
-                                                                   levelNode->getOrientation().w));
-
-        levelMotionState->kinematicSetPosition(newBtLevelTransform);
-
-        // move the target
-        btRigidBody* targetBody = m_currentLevel->getTargetBody();
-        OgreMotionState* targetMotionState =
-            dynamic_cast<OgreMotionState*>(targetBody->getMotionState());
-
-        Ogre::Vector3 targetWorldPosition = targetNode->_getDerivedPosition();
+        // the target is a child of the level node, physics moves it along
+        m_currentLevel->getPhysics()->setLevelOrientation(
+            btQuaternion(levelNode->getOrientation().x,
+                         levelNode->getOrientation().y,
+                         levelNode->getOrientation().z,
+                         levelNode->getOrientation().w));
 
-        btTransform newBtTargetTransform =
-            btTransform(btQuaternion(targetNode->getOrientation().x,
-                                     targetNode->getOrientation().y,
-                                     targetNode->getOrientation().z,
-                                     targetNode->getOrientation().w),
-                        btVector3(targetWorldPosition.x,
-                                  targetWorldPosition.y,
-                                  targetWorldPosition.z));
-
-        targetMotionState->kinematicSetPosition(newBtTargetTransform);
-
-        // check whether the ball fell off the level
+        // check whether the ball fell off the level; only the ball and the
+        // tilt need to go back to the start, not the whole level
         Ogre::Vector3 ballWorldPosition = ballNode->_getDerivedPosition();
 
         if(ballWorldPosition.y < -100)
-            reloadCurrentLevel();
+            m_currentLevel->reset();
+
+        m_currentLevel->updateWalls();
 
         return true;
     }
 
+    void RunningState::simulate(float p_elapsed)
+    {
+        PhysicsWorld* physicsWorld = m_engine->getPhysicsWorld();
+        physicsWorld->step(p_elapsed);
+
+        // the step is over, so the world can be changed again
+        CollisionEvent event;
+        while(physicsWorld->getCollisionEvents().pop(event))
+        {
+            switch(event.m_type)
+            {
+            case CollisionEvent::EVENT_TARGET_REACHED:
+                if(!m_levelCompleted)
+                {
+                    std::clog << "Level complete!" << std::endl;
+                    completeLevel();
+                }
+                break;
+
+            case CollisionEvent::EVENT_WALL_IMPACT:
+                m_engine->getAudioSystem()->playImpactSound(event.m_impulse);
+                break;
+
+            case CollisionEvent::EVENT_HAZARD_HIT:
+                // resetting drops the rest of the events too
+                m_currentLevel->reset();
+                return;
+
+            default:
+                break;
+            }
+        }
+    }
+
     bool RunningState::mouseMoved(const OIS::MouseEvent& evt)
     {
         return true;
@@ -129,7 +173,17 @@ namespace TiltBall
         if (evt.key == OIS::KC_Q)
             m_engine->requestQuit();
         if (evt.key == OIS::KC_ESCAPE)
-            m_engine->pushState(new MenuState(m_engine));
+        {
+            MenuState* menu = m_engine->getMenuState();
+            menu->show();
+            m_engine->pushState(menu);
+        }
+        if (evt.key == OIS::KC_F2)
+            m_engine->getProfilerOverlay()->toggle();
+        if (evt.key == OIS::KC_F3)
+            m_engine->getProfilerOverlay()->dump("frame_timings");
+        if (evt.key == OIS::KC_F4 && Trace::isEnabled())
+            Trace::writeFile("trace.json");
 
         return true;
     }
@@ -139,29 +193,62 @@ namespace TiltBall
         return true;
     }
 
+    void RunningState::completeLevel()
+    {
+        m_levelCompleted = true;
+    }
+
     void RunningState::loadNextLevel()
     {
-        std::string nextLevelFileName = m_currentLevel->getNextLevelFileName();
+        TraceZone zone("RunningState::loadNextLevel");
+
+        m_levelCompleted = false;
 
-        std::fstream stream(nextLevelFileName);
-        if(!stream.good())
+        // normally prepared long before the level is finished, otherwise
+        // this waits for it. whatever went wrong preparing it on the
+        // worker thread is rethrown here, and leaves nothing to go on to
+        std::shared_ptr<PreparedLevel> nextLevel;
+        try
+        {
+            nextLevel = m_nextLevel.get();
+        }
+        catch(std::exception& error)
+        {
+            std::clog << "Could not prepare the next level: " << error.what() << std::endl;
+        }
+
+        if(!nextLevel)
         {
             m_engine->requestQuit();
             return;
         }
-        stream.close();
 
         delete m_currentLevel;
 
-        m_currentLevel = new Level(m_engine, nextLevelFileName);
+        m_currentLevel = new Level(m_engine, nextLevel);
+
+        startPreloading();
     }
 
-    void RunningState::reloadCurrentLevel()
+    void RunningState::startPreloading()
     {
-        std::string fileName = m_currentLevel->getFileName();
-
-        delete m_currentLevel;
-
-        m_currentLevel = new Level(m_engine, fileName);
+        std::string fileName = m_currentLevel->getNextLevelFileName();
+        ColliderCache* colliderCache = m_engine->getColliderCache();
+        bool wallGeometry = m_currentLevel->getPreparedLevel()->hasWallGeometry();
+
+        m_nextLevel = std::async(std::launch::async,
+                                 [fileName, colliderCache, wallGeometry]()
+                                 -> std::shared_ptr<PreparedLevel>
+                                 {
+                                     // there is nothing after the last level
+                                     if(!AssetPack::exists(fileName))
+                                         return std::shared_ptr<PreparedLevel>();
+
+                                     return std::make_shared<PreparedLevel>(
+                                         fileName,
+                                         LevelCollider::COLLIDER_TRIANGLE_MESH,
+                                         colliderCache,
+                                         wallGeometry);
+                                 });
     }
 }
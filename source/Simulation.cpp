@@ -0,0 +1,157 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Simulation.hpp"
+
+namespace TiltBall
+{
+    Simulation::Simulation(std::string p_levelFileName,
+                           const TiltScript& p_script,
+                           LevelCollider::ColliderType p_colliderType) :
+        m_levelPhysics(0),
+        m_script(p_script),
+        m_levelOrientation(btQuaternion::getIdentity()),
+        m_stepCount(0),
+        m_wallImpactCount(0),
+        m_eventLog(0)
+    {
+        m_description.load(p_levelFileName);
+
+        m_levelPhysics = new LevelPhysics(&m_physicsWorld,
+                                          m_description,
+                                          std::make_shared<LevelCollider>(m_description,
+                                                                          p_colliderType,
+                                                                          ""),
+                                          new TransformMotionState(),
+                                          new TransformMotionState());
+    }
+
+    Simulation::~Simulation()
+    {
+        delete m_levelPhysics;
+    }
+
+    Simulation::Outcome Simulation::run(float p_maxSeconds)
+    {
+        while(getSimulatedTime() < p_maxSeconds)
+        {
+            step();
+
+            if(isBallOnTarget())
+                return OUTCOME_TARGET_REACHED;
+
+            // same check the game uses to restart the level
+            if(getBallPosition().y() < -100)
+                return OUTCOME_BALL_FELL_OFF;
+        }
+
+        return OUTCOME_TIMED_OUT;
+    }
+
+    void Simulation::step()
+    {
+        float time = getSimulatedTime();
+
+        float timeStep = m_physicsWorld.getFixedTimeStep();
+
+        // roll around the level's own z axis and pitch around the world x
+        // axis, the same way the game turns the level node
+        btScalar roll = -m_script.getRollRate(time) * timeStep * SIMD_RADS_PER_DEG;
+        btScalar pitch = m_script.getPitchRate(time) * timeStep * SIMD_RADS_PER_DEG;
+
+        m_levelOrientation = m_levelOrientation * btQuaternion(btVector3(0, 0, 1), roll);
+        m_levelOrientation = btQuaternion(btVector3(1, 0, 0), pitch) * m_levelOrientation;
+        m_levelOrientation.normalize();
+
+        m_levelPhysics->setLevelOrientation(m_levelOrientation);
+
+        // exactly one fixed step per call
+        m_physicsWorld.step(timeStep);
+        m_stepCount++;
+    }
+
+    void Simulation::reset()
+    {
+        m_levelPhysics->reset();
+        m_levelOrientation = btQuaternion::getIdentity();
+        m_stepCount = 0;
+        m_wallImpactCount = 0;
+    }
+
+    bool Simulation::isBallOnTarget()
+    {
+        bool targetReached = false;
+
+        CollisionEvent event;
+        while(m_physicsWorld.getCollisionEvents().pop(event))
+        {
+            switch(event.m_type)
+            {
+            case CollisionEvent::EVENT_TARGET_REACHED:
+                if(m_eventLog)
+                    *m_eventLog << getSimulatedTime() << " s: target reached" << std::endl;
+                targetReached = true;
+                break;
+
+            case CollisionEvent::EVENT_WALL_IMPACT:
+                if(m_eventLog)
+                    *m_eventLog << getSimulatedTime() << " s: wall impact, impulse "
+                                << event.m_impulse << std::endl;
+                m_wallImpactCount++;
+                break;
+
+            case CollisionEvent::EVENT_HAZARD_HIT:
+                if(m_eventLog)
+                    *m_eventLog << getSimulatedTime() << " s: hazard hit" << std::endl;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        return targetReached;
+    }
+
+    int Simulation::getStepCount() const
+    {
+        return m_stepCount;
+    }
+
+    float Simulation::getSimulatedTime() const
+    {
+        return m_stepCount * m_physicsWorld.getFixedTimeStep();
+    }
+
+    btVector3 Simulation::getBallPosition()
+    {
+        return m_levelPhysics->getBallBody()->getWorldTransform().getOrigin();
+    }
+
+    int Simulation::getWallImpactCount() const
+    {
+        return m_wallImpactCount;
+    }
+
+    void Simulation::setEventLog(std::ostream* p_stream)
+    {
+        m_eventLog = p_stream;
+    }
+}
@@ -0,0 +1,100 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SynchronizedStreamBuffer.hpp"
+
+#include <map>
+
+namespace TiltBall
+{
+    SynchronizedStreamBuffer::SynchronizedStreamBuffer(std::streambuf* p_target) :
+        m_target(p_target)
+    {
+    }
+
+    int SynchronizedStreamBuffer::overflow(int p_character)
+    {
+        if(p_character == traits_type::eof())
+            return traits_type::not_eof(p_character);
+
+        std::string& text = getPendingText();
+        text += traits_type::to_char_type(p_character);
+
+        if(p_character == '\n' && !writePendingText(text))
+            return traits_type::eof();
+
+        return p_character;
+    }
+
+    std::streamsize SynchronizedStreamBuffer::xsputn(const char* p_data, std::streamsize p_size)
+    {
+        std::string& text = getPendingText();
+        text.append(p_data, p_size);
+
+        // a chunk may end several lines at once, they go out together
+        if(text.find('\n') != std::string::npos)
+        {
+            std::string::size_type lineEnd = text.rfind('\n') + 1;
+            std::string rest = text.substr(lineEnd);
+            text.erase(lineEnd);
+
+            bool written = writePendingText(text);
+            text = rest;
+
+            if(!written)
+                return 0;
+        }
+
+        return p_size;
+    }
+
+    int SynchronizedStreamBuffer::sync()
+    {
+        std::string& text = getPendingText();
+        if(!writePendingText(text))
+            return -1;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_target->pubsync();
+    }
+
+    std::string& SynchronizedStreamBuffer::getPendingText()
+    {
+        // per buffer as well as per thread, though the game only has one
+        thread_local std::map<const SynchronizedStreamBuffer*, std::string> pendingText;
+        return pendingText[this];
+    }
+
+    bool SynchronizedStreamBuffer::writePendingText(std::string& p_text)
+    {
+        if(p_text.empty())
+            return true;
+
+        std::streamsize size = p_text.size();
+        bool written;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            written = m_target->sputn(p_text.data(), size) == size;
+        }
+
+        p_text.clear();
+        return written;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TiltScript.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace TiltBall
+{
+    TiltScript::TiltScript()
+    {
+    }
+
+    void TiltScript::load(std::string p_fileName)
+    {
+        std::ifstream stream(p_fileName.c_str());
+        if(!stream.good())
+            throw std::runtime_error("Could not open tilt script " + p_fileName);
+
+        m_entries.clear();
+
+        std::string line;
+        int lineNumber = 0;
+        while(std::getline(stream, line))
+        {
+            lineNumber++;
+
+            // skip empty lines and comments
+            if(line.find_first_not_of(" \t") == std::string::npos ||
+               line[line.find_first_not_of(" \t")] == '#')
+                continue;
+
+            std::istringstream lineStream(line);
+            float duration;
+            float rollRate;
+            float pitchRate;
+
+            if(!(lineStream >> duration >> rollRate >> pitchRate) || duration < 0)
+            {
+                std::ostringstream error;
+                error << p_fileName << ':' << lineNumber << ": expected "
+                      << "<seconds> <roll rate> <pitch rate>";
+                throw std::runtime_error(error.str());
+            }
+
+            append(duration, rollRate, pitchRate);
+        }
+    }
+
+    void TiltScript::append(float p_seconds, float p_rollRate, float p_pitchRate)
+    {
+        Entry entry;
+        entry.m_endTime = getDuration() + p_seconds;
+        entry.m_rollRate = p_rollRate;
+        entry.m_pitchRate = p_pitchRate;
+        m_entries.push_back(entry);
+    }
+
+    float TiltScript::getDuration() const
+    {
+        return m_entries.empty() ? 0 : m_entries.back().m_endTime;
+    }
+
+    float TiltScript::getRollRate(float p_time) const
+    {
+        const Entry* entry = findEntry(p_time);
+        return entry ? entry->m_rollRate : 0;
+    }
+
+    float TiltScript::getPitchRate(float p_time) const
+    {
+        const Entry* entry = findEntry(p_time);
+        return entry ? entry->m_pitchRate : 0;
+    }
+
+    const TiltScript::Entry* TiltScript::findEntry(float p_time) const
+    {
+        for(auto it = m_entries.begin(); it < m_entries.end(); it++)
+            if(p_time < (*it).m_endTime)
+                return &(*it);
+
+        return 0;
+    }
+}
@@ -0,0 +1,199 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace TiltBall
+{
+    struct TraceEvent
+    {
+        const char* m_name;
+        uint32_t m_threadId;
+        // microseconds since the trace epoch
+        uint64_t m_start;
+        uint64_t m_duration;
+    };
+
+    // written by one thread only; readers copy what they need and then
+    // check how far the writer got meanwhile, throwing away whatever it
+    // may have overwritten
+    struct TraceBuffer
+    {
+        TraceEvent m_events[Trace::BUFFER_CAPACITY];
+        std::atomic<uint64_t> m_written;
+    };
+
+    std::atomic<bool> Trace::s_enabled(false);
+
+    static const std::chrono::steady_clock::time_point TRACE_EPOCH =
+        std::chrono::steady_clock::now();
+
+    // every buffer ever handed out, and those whose thread has finished;
+    // the buffers are kept for writing out and reused by later threads
+    static std::mutex s_buffersMutex;
+    static std::vector<TraceBuffer*> s_buffers;
+    static std::vector<TraceBuffer*> s_freeBuffers;
+    static std::atomic<uint32_t> s_nextThreadId(1);
+
+    // takes a buffer the first time its thread records and gives it back
+    // when the thread finishes
+    class ThreadTraceBuffer
+    {
+    public:
+        ThreadTraceBuffer() :
+            m_buffer(0),
+            m_threadId(s_nextThreadId++)
+        {
+        }
+
+        ThreadTraceBuffer(const ThreadTraceBuffer& p_other) = delete;
+
+        ThreadTraceBuffer& operator=(const ThreadTraceBuffer& p_other) = delete;
+
+        ~ThreadTraceBuffer()
+        {
+            if(m_buffer)
+            {
+                std::lock_guard<std::mutex> lock(s_buffersMutex);
+                s_freeBuffers.push_back(m_buffer);
+            }
+        }
+
+        TraceBuffer* getBuffer()
+        {
+            if(!m_buffer)
+            {
+                std::lock_guard<std::mutex> lock(s_buffersMutex);
+
+                if(s_freeBuffers.empty())
+                {
+                    m_buffer = new TraceBuffer();
+                    m_buffer->m_written = 0;
+                    s_buffers.push_back(m_buffer);
+                }
+                else
+                {
+                    m_buffer = s_freeBuffers.back();
+                    s_freeBuffers.pop_back();
+                }
+            }
+
+            return m_buffer;
+        }
+
+        uint32_t getThreadId() const
+        {
+            return m_threadId;
+        }
+
+    private:
+        TraceBuffer* m_buffer;
+        uint32_t m_threadId;
+    };
+
+    static thread_local ThreadTraceBuffer s_threadBuffer;
+
+    static uint64_t toMicroseconds(std::chrono::steady_clock::duration p_duration)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(p_duration).count();
+    }
+
+    void Trace::setEnabled(bool p_enabled)
+    {
+        s_enabled = p_enabled;
+    }
+
+    void Trace::record(const char* p_name,
+                       std::chrono::steady_clock::time_point p_start,
+                       std::chrono::steady_clock::time_point p_end)
+    {
+        TraceBuffer* buffer = s_threadBuffer.getBuffer();
+
+        uint64_t index = buffer->m_written.load(std::memory_order_relaxed);
+
+        TraceEvent& event = buffer->m_events[index % Trace::BUFFER_CAPACITY];
+        event.m_name = p_name;
+        event.m_threadId = s_threadBuffer.getThreadId();
+        event.m_start = toMicroseconds(p_start - TRACE_EPOCH);
+        event.m_duration = toMicroseconds(p_end - p_start);
+
+        buffer->m_written.store(index + 1, std::memory_order_release);
+    }
+
+    void Trace::write(std::ostream& p_stream)
+    {
+        std::vector<TraceBuffer*> buffers;
+        {
+            std::lock_guard<std::mutex> lock(s_buffersMutex);
+            buffers = s_buffers;
+        }
+
+        std::vector<TraceEvent> events;
+        events.reserve(Trace::BUFFER_CAPACITY);
+
+        p_stream << "{\"traceEvents\":[";
+
+        bool first = true;
+        for(auto it = buffers.begin(); it < buffers.end(); it++)
+        {
+            TraceBuffer* buffer = *it;
+
+            uint64_t written = buffer->m_written.load(std::memory_order_acquire);
+            uint64_t begin = written > Trace::BUFFER_CAPACITY ? written - Trace::BUFFER_CAPACITY : 0;
+
+            events.clear();
+            for(uint64_t i = begin; i < written; i++)
+                events.push_back(buffer->m_events[i % Trace::BUFFER_CAPACITY]);
+
+            // the writer may be filling the slot of the zone after its
+            // last one, which is where the oldest ones are
+            uint64_t writtenAfter = buffer->m_written.load(std::memory_order_acquire);
+            uint64_t safeBegin = writtenAfter >= Trace::BUFFER_CAPACITY ?
+                writtenAfter - Trace::BUFFER_CAPACITY + 1 : 0;
+
+            for(uint64_t i = std::max(begin, safeBegin); i < written; i++)
+            {
+                const TraceEvent& event = events[i - begin];
+
+                p_stream << (first ? "" : ",") << "\n{\"name\":\"" << event.m_name
+                         << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.m_threadId
+                         << ",\"ts\":" << event.m_start
+                         << ",\"dur\":" << event.m_duration << "}";
+                first = false;
+            }
+        }
+
+        p_stream << "\n]}\n";
+    }
+
+    void Trace::writeFile(std::string p_fileName)
+    {
+        std::clog << "Writing trace to " << p_fileName << "..." << std::endl;
+
+        std::ofstream stream(p_fileName.c_str());
+        write(stream);
+    }
+}
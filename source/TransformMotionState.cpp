@@ -0,0 +1,69 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TransformMotionState.hpp"
+
+namespace TiltBall
+{
+    TransformMotionState::TransformMotionState()
+    {
+        m_position.setIdentity();
+        m_previousPosition.setIdentity();
+    }
+
+    TransformMotionState::~TransformMotionState()
+    {
+    }
+
+    void TransformMotionState::getWorldTransform(btTransform& p_worldTrans) const
+    {
+        p_worldTrans = m_position;
+    }
+
+    void TransformMotionState::setWorldTransform(const btTransform& p_worldTrans)
+    {
+        m_position = p_worldTrans;
+    }
+
+    void TransformMotionState::kinematicSetPosition(const btTransform& p_worldTrans)
+    {
+        // also used to place bodies initially, so there is nothing to
+        // interpolate from
+        m_position = p_worldTrans;
+        m_previousPosition = p_worldTrans;
+    }
+
+    void TransformMotionState::savePreviousPosition()
+    {
+        m_previousPosition = m_position;
+    }
+
+    btTransform TransformMotionState::getInterpolatedTransform(btScalar p_alpha) const
+    {
+        return btTransform(m_previousPosition.getRotation().slerp(m_position.getRotation(),
+                                                                  p_alpha),
+                           m_previousPosition.getOrigin().lerp(m_position.getOrigin(),
+                                                               p_alpha));
+    }
+
+    void TransformMotionState::interpolate(btScalar p_alpha)
+    {
+    }
+}
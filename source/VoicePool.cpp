@@ -0,0 +1,101 @@
+/*
+This file is part of TiltBall.
+http://github.com/rradonic/tilt-ball
+
+Copyright (C) 2009-2011 Ranko Radonić
+
+TiltBall is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TiltBall is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TiltBall.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VoicePool.hpp"
+
+namespace TiltBall
+{
+    VoicePool::VoicePool(int p_voiceCount) :
+        m_voices(p_voiceCount),
+        m_playCount(0)
+    {
+        for(auto it = m_voices.begin(); it < m_voices.end(); it++)
+        {
+            alGenSources(1, &it->m_source);
+            it->m_priority = 0;
+            it->m_started = 0;
+        }
+    }
+
+    VoicePool::~VoicePool()
+    {
+        for(auto it = m_voices.begin(); it < m_voices.end(); it++)
+        {
+            alSourceStop(it->m_source);
+            alDeleteSources(1, &it->m_source);
+        }
+    }
+
+    bool VoicePool::play(ALuint p_buffer, int p_priority, float p_gain, float p_pitch)
+    {
+        Voice* chosen = 0;
+
+        for(auto it = m_voices.begin(); it < m_voices.end(); it++)
+        {
+            if(!isPlaying(*it))
+            {
+                chosen = &*it;
+                break;
+            }
+
+            // the least important, and of those the oldest
+            if(it->m_priority <= p_priority &&
+               (!chosen ||
+                it->m_priority < chosen->m_priority ||
+                (it->m_priority == chosen->m_priority && it->m_started < chosen->m_started)))
+                chosen = &*it;
+        }
+
+        if(!chosen)
+            return false;
+
+        alSourceStop(chosen->m_source);
+        alSourcei(chosen->m_source, AL_BUFFER, p_buffer);
+        alSourcef(chosen->m_source, AL_GAIN, p_gain);
+        alSourcef(chosen->m_source, AL_PITCH, p_pitch);
+        alSourcePlay(chosen->m_source);
+
+        chosen->m_priority = p_priority;
+        chosen->m_started = ++m_playCount;
+
+        return true;
+    }
+
+    int VoicePool::countPlaying(int p_priority)
+    {
+        int count = 0;
+
+        for(auto it = m_voices.begin(); it < m_voices.end(); it++)
+        {
+            if(it->m_priority == p_priority && isPlaying(*it))
+                count++;
+        }
+
+        return count;
+    }
+
+    bool VoicePool::isPlaying(const Voice& p_voice)
+    {
+        ALint state;
+        alGetSourcei(p_voice.m_source, AL_SOURCE_STATE, &state);
+
+        return state == AL_PLAYING;
+    }
+}
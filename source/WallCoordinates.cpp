@@ -30,22 +30,22 @@ namespace TiltBall
     {
     }
 
-    int WallCoordinates::getBeginX()
+    int WallCoordinates::getBeginX() const
     {
         return m_beginX;
     }
 
-    int WallCoordinates::getBeginZ()
+    int WallCoordinates::getBeginZ() const
     {
         return m_beginZ;
     }
 
-    int WallCoordinates::getEndX()
+    int WallCoordinates::getEndX() const
     {
         return m_endX;
     }
 
-    int WallCoordinates::getEndZ()
+    int WallCoordinates::getEndZ() const
     {
         return m_endZ;
     }